@@ -1,8 +1,10 @@
 // os_simulator_sjf_lru.cpp
-// Simulador SO con CLI, scheduler (RR y SJF no-expropiativo) y paginacion (FIFO/LRU global).
-// Compilar: g++ -std=c++17 os_simulator_sjf_lru.cpp -o os_simulator
+// Simulador SO con CLI, scheduler (RR/SJF/SRTF/MLFQ/CFS/stride/lotería, 1..N CPUs) y paginacion (FIFO/LRU/CLOCK/OPT global).
+// Compilar: g++ -std=c++17 -pthread os_simulator_sjf_lru.cpp -o os_simulator
 // Ejecutar: ./os_simulator
 #include <bits/stdc++.h>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
 using namespace std;
 
 
@@ -24,29 +26,94 @@ static std::mt19937 rng((unsigned)chrono::system_clock::now().time_since_epoch()
 
 
 // PCB (Bloque de Control de Proceso)
+// Se divide en dos partes guardadas en arreglos paralelos del planificador:
+// PCB con los campos que el planificador toca en cada tick (compacto y contiguo) y
+// PCBInfo con la memoria virtual y las estadísticas, que se consultan con menos frecuencia.
 
 struct PCB {
     int pid;
     Estado estado;
     int rafaga_restante;   // tiempo CPU restante
+    long long ready_since; // tick desde el que cuenta la espera del periodo READY actual
+    // enlaces de la lista intrusiva de listos (pids, -1 = ninguno)
+    int rq_prev, rq_next;
+    // enlaces de la lista de su nivel MLFQ
+    int lvl_prev, lvl_next;
+    bool in_ready;         // está en la estructura de listos
+    // MLFQ: nivel de prioridad (0 = más alta) y ticks consumidos de la asignación del nivel
+    int level;
+    int level_used;
+    // CFS: tiempo virtual (en 1/1024 de tick ponderado) y peso derivado del nice
+    long long vruntime;
+    int weight;
+    // Stride / lotería: boletos del proceso y su pase (avanza STRIDE1 / tickets por tick)
+    int tickets;
+    long long pass;
+    int cpu;               // CPU en cuya cola está o en la que corre (-1 = ninguna todavía)
+
+    PCB(int _pid=0, int burst=0, long long now=0)
+        : pid(_pid), estado(Estado::NEW), rafaga_restante(burst), ready_since(now),
+          rq_prev(-1), rq_next(-1), lvl_prev(-1), lvl_next(-1), in_ready(false),
+          level(0), level_used(0), vruntime(0), weight(1024), tickets(100), pass(0), cpu(-1) {}
+};
+
+struct PCBInfo {
     int rafaga_total;
-    int llegada_tick;
-    int inicio_tick;       // primer tick que corrió
-    int fin_tick;          // tick de finalización
-    int espera_acumulada;
+    long long llegada_tick;
+    long long inicio_tick;       // primer tick que corrió
+    long long fin_tick;          // tick de finalización
+    long long espera_acumulada;  // espera de los periodos READY ya cerrados
     // Memoria virtual: páginas del proceso (0..npages-1)
     int npages;
     vector<int> trace;     // traza opcional de páginas a acceder en cada ejecución
+    vector<int> trace_next; // distancia (en accesos del proceso) al próximo uso de trace[i], para OPT
     int trace_pos;
 
     // estadísticas de paginación
     int page_faults;
 
-    PCB(int _pid=0, int burst=0, int now=0, int pages=4)
-        : pid(_pid), estado(Estado::NEW), rafaga_restante(burst),
-          rafaga_total(burst), llegada_tick(now), inicio_tick(-1), fin_tick(-1),
-          espera_acumulada(0), npages(pages), trace_pos(0), page_faults(0) {}
+    int nice;              // -20..19, solo lo usa CFS
+
+    // Ráfagas de E/S: al terminar cada ráfaga de CPU sigue io[io_next] = (ticks de E/S en el
+    // dispositivo 'device', ráfaga de CPU siguiente). rafaga_total suma todas las ráfagas de CPU.
+    vector<pair<int,int>> io;
+    int io_next;
+    int device;
+
+    PCBInfo(int burst=0, long long now=0, int pages=4)
+        : rafaga_total(burst), llegada_tick(now), inicio_tick(-1), fin_tick(-1),
+          espera_acumulada(0), npages(pages), trace_pos(0), page_faults(0), nice(0),
+          io_next(0), device(0) {}
 };
+// Registro final compacto de un proceso terminado (archivo de procesos cosechados)
+struct ProcessRecord {
+    int pid;
+    int rafaga_restante;   // > 0 si fue eliminado con kill antes de terminar
+    int rafaga_total;
+    int npages;
+    long long llegada_tick;
+    long long inicio_tick;
+    long long fin_tick;
+    long long espera;
+    int page_faults;
+};
+
+
+// Precalcula, para cada posición de una traza cíclica, cuántos accesos faltan
+// para que se vuelva a usar la misma página (1..len). Las páginas se normalizan igual que al ejecutar.
+vector<int> compute_next_use(const vector<int> &trace, int npages) {
+    int len = (int)trace.size();
+    vector<int> next(len, len);
+    unordered_map<int,int> seen; // página -> última posición vista (recorriendo hacia atrás)
+    for (int i = 2 * len - 1; i >= 0; --i) {
+        int page = trace[i % len];
+        if (npages > 0 && (page < 0 || page >= npages)) page = page % npages;
+        auto it = seen.find(page);
+        if (i < len && it != seen.end()) next[i] = it->second - i;
+        seen[page] = i;
+    }
+    return next;
+}
 
 
 // Frame y administrador de memoria
@@ -57,10 +124,25 @@ struct Frame {
     int page;       // número de pagina
     long long loaded_at_tick; // para FIFO
     long long last_access_tick; // para LRU
-    Frame(int id=0): fid(id), pid(-1), page(-1), loaded_at_tick(-1), last_access_tick(-1) {}
+    bool referenced;  // bit de referencia para CLOCK
+    Frame(int id=0): fid(id), pid(-1), page(-1), loaded_at_tick(-1), last_access_tick(-1), referenced(false) {}
 };
 
-enum class ReplPolicy { FIFO, LRU };
+enum class ReplPolicy { FIFO, LRU, CLOCK, OPT };
+string repl_policy_to_str(ReplPolicy p) {
+    switch (p) {
+        case ReplPolicy::FIFO: return "FIFO";
+        case ReplPolicy::LRU: return "LRU";
+        case ReplPolicy::CLOCK: return "CLOCK";
+        case ReplPolicy::OPT: return "OPT";
+    }
+    return "?";
+}
+bool parse_repl_policy(const string &s, ReplPolicy &out) {
+    for (ReplPolicy p : {ReplPolicy::FIFO, ReplPolicy::LRU, ReplPolicy::CLOCK, ReplPolicy::OPT})
+        if (s == repl_policy_to_str(p)) { out = p; return true; }
+    return false;
+}
 
 // Administrador de memoria: conjunto de frames global, reemplazo global
 class MemoryManager {
@@ -68,8 +150,131 @@ private:
     vector<Frame> frames;
     ReplPolicy policy;
     long long tick_counter = 0;
-    // Para FIFO mantenemos una cola de IDs de frames en orden de carga
-    deque<int> fifo_queue;
+    // Para FIFO mantenemos un buffer circular de IDs de frames en orden de carga.
+    // Se mantiene con cualquier política, así cambiar de política es O(1) y no se pierde el orden.
+    // Las posiciones son absolutas (fifo_head..fifo_tail) y se mapean módulo la capacidad.
+    // Un reemplazo hecho en modo LRU reencola el frame y deja su entrada vieja obsoleta;
+    // por eso la capacidad es 2*nframes y se compacta cuando se llena.
+    vector<int> fifo_ring;
+    vector<long long> fifo_slot; // posición absoluta de la entrada vigente de cada frame
+    long long fifo_head = 0, fifo_tail = 0;
+    // Mapa de bits de frames libres (bit = 1 -> libre), 64 frames por palabra
+    vector<uint64_t> free_bits;
+    int free_count = 0;
+    // Frames residentes por proceso; proc_slot[fid] es la posición del frame en la lista de su dueño
+    unordered_map<int, vector<int>> proc_frames;
+    vector<int> proc_slot;
+    // Para CLOCK: manecilla que recorre los frames de forma circular
+    int clock_hand = 0;
+    // Para OPT (Belady): tick estimado del próximo uso de cada frame (LLONG_MAX = desconocido)
+    // y un max-heap (próximo uso, fid, versión) con borrado perezoso por versión.
+    vector<long long> opt_next, opt_stamp;
+    priority_queue<tuple<long long,int,long long>> opt_heap;
+
+    void opt_set_next(int fid, long long next_use) {
+        opt_next[fid] = next_use;
+        opt_stamp[fid]++;
+        if (policy != ReplPolicy::OPT) return;
+        // reconstruye si las entradas obsoletas dominan el heap
+        if (opt_heap.size() > 4 * frames.size() + 64) opt_rebuild();
+        else opt_heap.emplace(next_use, fid, opt_stamp[fid]);
+    }
+
+    void opt_rebuild() {
+        vector<tuple<long long,int,long long>> live;
+        live.reserve(frames.size());
+        for (auto &f : frames)
+            if (f.pid != -1) live.emplace_back(opt_next[f.fid], f.fid, opt_stamp[f.fid]);
+        opt_heap = priority_queue<tuple<long long,int,long long>>(less<tuple<long long,int,long long>>(), std::move(live));
+    }
+
+    void own_frame(int pid, int fid) {
+        auto &lst = proc_frames[pid];
+        proc_slot[fid] = (int)lst.size();
+        lst.push_back(fid);
+    }
+
+    // Quita fid de la lista de su dueño actual (swap con el último)
+    void disown_frame(int fid) {
+        auto it = proc_frames.find(frames[fid].pid);
+        if (it == proc_frames.end()) return;
+        auto &lst = it->second;
+        int pos = proc_slot[fid];
+        lst[pos] = lst.back();
+        proc_slot[lst[pos]] = pos;
+        lst.pop_back();
+        proc_slot[fid] = -1;
+        if (lst.empty()) proc_frames.erase(it);
+    }
+
+    // Busca el frame libre de menor id, -1 si la memoria está llena
+    int take_free_frame() {
+        if (free_count == 0) return -1;
+        for (size_t w = 0; w < free_bits.size(); ++w) {
+            if (free_bits[w] == 0) continue;
+            int fid = (int)(w * 64) + __builtin_ctzll(free_bits[w]);
+            free_bits[w] &= free_bits[w] - 1;
+            free_count--;
+            return fid;
+        }
+        return -1;
+    }
+    // Tabla de paginas invertida: (pid,page) -> frame id, sincronizada con load_page
+    unordered_map<long long, int> page_table;
+    // Para LRU: lista doblemente enlazada intrusiva de frames ocupados por recencia.
+    // lru_head = menos recientemente usado, lru_tail = más reciente.
+    vector<int> lru_prev, lru_next;
+    int lru_head = -1, lru_tail = -1;
+
+    void lru_unlink(int fid) {
+        int p = lru_prev[fid], n = lru_next[fid];
+        if (p != -1) lru_next[p] = n; else lru_head = n;
+        if (n != -1) lru_prev[n] = p; else lru_tail = p;
+        lru_prev[fid] = lru_next[fid] = -1;
+    }
+
+    void lru_push_back(int fid) {
+        lru_prev[fid] = lru_tail;
+        lru_next[fid] = -1;
+        if (lru_tail != -1) lru_next[lru_tail] = fid; else lru_head = fid;
+        lru_tail = fid;
+    }
+
+    // Mueve un frame ocupado al extremo más reciente de la lista
+    void lru_touch(int fid) {
+        if (lru_tail == fid) return;
+        lru_unlink(fid);
+        lru_push_back(fid);
+    }
+
+    bool fifo_entry_valid(long long pos) const {
+        int fid = fifo_ring[pos % fifo_ring.size()];
+        return frames[fid].pid != -1 && fifo_slot[fid] == pos;
+    }
+
+    // Agrega un frame recién cargado al final del orden de carga
+    void fifo_push(int fid) {
+        long long cap = (long long)fifo_ring.size();
+        if (fifo_tail - fifo_head == cap) {
+            // compacta descartando entradas obsoletas (hay al menos nframes)
+            long long w = fifo_head;
+            for (long long r = fifo_head; r < fifo_tail; ++r) {
+                if (!fifo_entry_valid(r)) continue;
+                int f = fifo_ring[r % cap];
+                fifo_ring[w % cap] = f;
+                fifo_slot[f] = w++;
+            }
+            fifo_tail = w;
+        }
+        fifo_ring[fifo_tail % cap] = fid;
+        fifo_slot[fid] = fifo_tail++;
+    }
+
+    // Extrae el frame cargado hace más tiempo
+    int fifo_pop() {
+        while (!fifo_entry_valid(fifo_head)) fifo_head++;
+        return fifo_ring[fifo_head++ % fifo_ring.size()];
+    }
 
     // estadísticas
     int total_page_faults = 0;
@@ -79,14 +284,30 @@ public:
     MemoryManager(int nframes=8, ReplPolicy p=ReplPolicy::FIFO) {
         frames.reserve(nframes);
         for (int i = 0; i < nframes; ++i) frames.emplace_back(i);
+        page_table.reserve(nframes);
+        lru_prev.assign(nframes, -1);
+        lru_next.assign(nframes, -1);
+        fifo_ring.assign(2 * (size_t)max(nframes, 1), -1);
+        fifo_slot.assign(nframes, -1);
+        free_bits.assign((nframes + 63) / 64, ~0ULL);
+        if (nframes % 64) free_bits.back() = (1ULL << (nframes % 64)) - 1;
+        free_count = nframes;
+        proc_slot.assign(nframes, -1);
+        opt_next.assign(nframes, LLONG_MAX);
+        opt_stamp.assign(nframes, 0);
         policy = p;
     }
 
+    // Clave de la tabla de paginas para (pid,page)
+    static long long page_key(int pid, int page) {
+        return ((long long)pid << 32) | (unsigned int)page;
+    }
+
     void set_policy(ReplPolicy p) {
+        // el orden FIFO y la lista LRU se mantienen siempre, no hay nada que reconstruir;
+        // el heap de OPT solo se mantiene en modo OPT y se arma al activarlo
         policy = p;
-        // reinicia la cola FIFO según los frames cargados
-        fifo_queue.clear();
-        for (auto &f : frames) if (f.pid != -1) fifo_queue.push_back(f.fid);
+        if (policy == ReplPolicy::OPT) opt_rebuild();
     }
 
     ReplPolicy get_policy() const { return policy; }
@@ -94,90 +315,137 @@ public:
     int num_frames() const { return (int)frames.size(); }
 
     void advance_tick() { tick_counter++; }
+    void advance_ticks(long long k) { tick_counter += k; }
 
   // Verifica si (pid,page) está en memoria; si sí, actualiza LRU y retorna true
     bool is_resident_and_touch(int pid, int page) {
-        for (auto &f : frames) {
-            if (f.pid == pid && f.page == page) {
-                f.last_access_tick = tick_counter;
-                return true;
-            }
-        }
-        return false;
+        return touch(pid, page) != -1;
+    }
+
+    // Marca el acceso a (pid,page) si está residente; retorna su frame o -1
+    int touch(int pid, int page) {
+        auto it = page_table.find(page_key(pid, page));
+        if (it == page_table.end()) return -1;
+        frames[it->second].last_access_tick = tick_counter;
+        frames[it->second].referenced = true;
+        lru_touch(it->second);
+        return it->second;
     }
 
     // Carga (pid,page) en memoria, posiblemente reemplazando otro frame
     int load_page(int pid, int page) {
         total_page_faults++;
         // busca frame libre
-        for (auto &f : frames) {
-            if (f.pid == -1) {
-                f.pid = pid; f.page = page;
-                f.loaded_at_tick = tick_counter;
-                f.last_access_tick = tick_counter;
-                if (policy == ReplPolicy::FIFO) fifo_queue.push_back(f.fid);
-                return f.fid;
-            }
+        int free_fid = take_free_frame();
+        if (free_fid != -1) {
+            Frame &f = frames[free_fid];
+            f.pid = pid; f.page = page;
+            page_table[page_key(pid, page)] = f.fid;
+            own_frame(pid, f.fid);
+            f.loaded_at_tick = tick_counter;
+            f.last_access_tick = tick_counter;
+            f.referenced = true;
+            lru_push_back(f.fid);
+            fifo_push(f.fid);
+            return f.fid;
         }
         // No hay frame libre, entonces se reemplazar
         int victim_fid = choose_victim();
         // realizar reemplazo
         Frame &vf = frames[victim_fid];
+        page_table.erase(page_key(vf.pid, vf.page));
+        disown_frame(victim_fid);
         vf.pid = pid;
         vf.page = page;
+        page_table[page_key(pid, page)] = victim_fid;
+        own_frame(pid, victim_fid);
         vf.loaded_at_tick = tick_counter;
         vf.last_access_tick = tick_counter;
+        vf.referenced = true;
+        lru_touch(victim_fid);
         total_replacements++;
-        if (policy == ReplPolicy::FIFO) {
-           // rotar la cola FIFO: eliminar víctima y agregar nuevo
-            auto it = find(fifo_queue.begin(), fifo_queue.end(), victim_fid);
-            if (it != fifo_queue.end()) fifo_queue.erase(it);
-            fifo_queue.push_back(victim_fid);
-        }
+        // la víctima pasa a ser la página cargada más reciente
+        fifo_push(victim_fid);
         return victim_fid;
     }
+    // Libera un frame ocupado y lo devuelve al mapa de bits de libres
+    void release_frame(int fid) {
+        Frame &f = frames[fid];
+        if (f.pid == -1) return;
+        page_table.erase(page_key(f.pid, f.page));
+        disown_frame(fid);
+        lru_unlink(fid);
+        opt_next[fid] = LLONG_MAX;
+        opt_stamp[fid]++;
+        // su entrada en el buffer FIFO queda obsoleta al quedar libre el frame
+        f = Frame(fid);
+        free_bits[fid / 64] |= 1ULL << (fid % 64);
+        free_count++;
+    }
+
+    // Libera todos los frames de un proceso (al terminar o ser eliminado).
+    // Costo proporcional a sus páginas residentes; retorna cuántos frames liberó.
+    int release_process(int pid) {
+        auto it = proc_frames.find(pid);
+        if (it == proc_frames.end()) return 0;
+        vector<int> owned = it->second;
+        for (int fid : owned) release_frame(fid);
+        return (int)owned.size();
+    }
+
+    int resident_pages(int pid) const {
+        auto it = proc_frames.find(pid);
+        return it == proc_frames.end() ? 0 : (int)it->second.size();
+    }
+
     // Selección de víctima para reemplazo
     int choose_victim() {
         if (policy == ReplPolicy::FIFO) {
-    // La víctima está al frente de la cola FIFO
-            if (fifo_queue.empty()) {
-                // fallback: encuentra el más antiguo por loaded_at_tick
-                long long minload = LLONG_MAX; int fid=0;
-                for (auto &f: frames) if (f.loaded_at_tick < minload) { minload=f.loaded_at_tick; fid=f.fid; }
-                return fid;
-            } else {
-                int fid = fifo_queue.front();
-                fifo_queue.pop_front();
-                return fid;
-            }
-        } else { // LRU
-            long long min_last = LLONG_MAX; int fid = 0;
-            for (auto &f : frames) {
-                if (f.last_access_tick < min_last) {
-                    min_last = f.last_access_tick;
-                    fid = f.fid;
-                }
+            // La víctima está al frente del buffer circular
+            return fifo_pop();
+        } else if (policy == ReplPolicy::CLOCK) {
+            // segunda oportunidad: limpia bits de referencia hasta encontrar uno en 0
+            int n = (int)frames.size();
+            while (frames[clock_hand].referenced) {
+                frames[clock_hand].referenced = false;
+                clock_hand = (clock_hand + 1) % n;
             }
+            int fid = clock_hand;
+            clock_hand = (clock_hand + 1) % n;
             return fid;
+        } else if (policy == ReplPolicy::OPT) {
+            // el frame cuyo próximo uso está más lejos (o es desconocido)
+            while (true) {
+                auto [next_use, fid, stamp] = opt_heap.top();
+                opt_heap.pop();
+                if (frames[fid].pid != -1 && opt_stamp[fid] == stamp) return fid;
+            }
+        } else { // LRU: la cabeza de la lista de recencia es el menos usado
+            return lru_head;
         }
     }
 
     // API: acceso a página, retorna par (tenía_página(bool), id_frame)
-    pair<bool,int> access_page(int pid, int page) {
+    // next_use_dist: accesos del proceso hasta volver a usar esta página (para OPT), -1 si se desconoce
+    pair<bool,int> access_page(int pid, int page, int next_use_dist = -1) {
     // Incrementar el contador de ticks para el contexto de marcas de tiempo LRU (quien llama también debe llamar a advance_tick)
     // En realidad, quien llama llamará a advance_tick antes; asumimos que tick_counter es el tick actual
     //Comprobar residente
-        if (is_resident_and_touch(pid,page)) {
-            return {true, -1};
-        } else {
-            int fid = load_page(pid,page);
-            return {false, fid};
+        bool hit = true;
+        int fid = touch(pid, page);
+        if (fid == -1) {
+            hit = false;
+            fid = load_page(pid, page);
         }
+        opt_set_next(fid, next_use_dist < 0 ? LLONG_MAX : tick_counter + next_use_dist);
+        if (hit) return {true, -1};
+        return {false, fid};
     }
 
     // estadísticas getters
     int get_total_page_faults() const { return total_page_faults; }
     int get_total_replacements() const { return total_replacements; }
+    int get_free_frames() const { return free_count; }
 
     // Mostrar estado de los frames
     void dump_frames() const {
@@ -185,197 +453,1480 @@ public:
         for (auto &f: frames) {
             cout << f.fid << " : ";
             if (f.pid == -1) cout << "<free>\n";
-            else cout << f.pid << "," << f.page << " (l@" << f.loaded_at_tick << " a@" << f.last_access_tick << ")\n";
+            else {
+                cout << f.pid << "," << f.page << " (l@" << f.loaded_at_tick << " a@" << f.last_access_tick << ")";
+                if (policy == ReplPolicy::CLOCK) cout << " r=" << f.referenced << (f.fid == clock_hand ? " <-hand" : "");
+                cout << "\n";
+            }
+        }
+    }
+};
+
+
+// Curvas de fallos (miss-ratio curves) por distancia de pila (Mattson)
+
+// Registro del flujo combinado de accesos (pid,page) en el orden en que ocurren.
+struct AccessLog {
+    bool enabled = false;
+    vector<long long> keys; // MemoryManager::page_key(pid,page)
+};
+
+// Reproduce un flujo de accesos una sola vez y calcula, para LRU, los fallos de página
+// de todos los tamaños de memoria 1..N. La distancia de pila de un acceso es el número de
+// páginas distintas usadas desde el acceso anterior a la misma página (incluyéndola):
+// es acierto para todo tamaño >= distancia. Un árbol de Fenwick sobre las posiciones del
+// flujo marca el último acceso de cada página, así cada distancia cuesta O(log n).
+// No modela la liberación de frames al terminar procesos: sus páginas simplemente envejecen.
+class StackDistanceEngine {
+private:
+    vector<int> bit;              // Fenwick 1-indexado sobre posiciones del flujo
+    unordered_map<long long,int> last_pos;
+    vector<long long> hist;       // hist[d] = accesos con distancia d
+    long long cold_misses = 0;
+    long long total = 0;
+
+    void bit_add(int i, int v) { for (++i; i < (int)bit.size(); i += i & -i) bit[i] += v; }
+    int bit_sum(int i) const { int r = 0; for (++i; i > 0; i -= i & -i) r += bit[i]; return r; } // suma [0..i]
+
+public:
+    explicit StackDistanceEngine(size_t stream_len) : bit(stream_len + 1, 0), hist(1, 0) {}
+
+    void access(long long key) {
+        int t = (int)total++;
+        auto it = last_pos.find(key);
+        if (it == last_pos.end()) {
+            cold_misses++;
+            last_pos.emplace(key, t);
+        } else {
+            int p = it->second;
+            // páginas distintas tocadas en (p, t) más la propia
+            long long d = bit_sum(t - 1) - bit_sum(p) + 1;
+            if ((long long)hist.size() <= d) hist.resize(d + 1, 0);
+            hist[d]++;
+            bit_add(p, -1);
+            it->second = t;
+        }
+        bit_add(t, +1);
+    }
+
+    long long accesses() const { return total; }
+    long long footprint() const { return (long long)last_pos.size(); }
+
+    // fallos[c-1] = fallos con c frames, para c = 1..max_frames
+    vector<long long> faults_curve(int max_frames) const {
+        vector<long long> out(max(0, max_frames));
+        long long beyond = 0; // accesos con distancia > c
+        for (size_t d = 1; d < hist.size(); ++d) beyond += hist[d];
+        for (int c = 1; c <= max_frames; ++c) {
+            if (c < (int)hist.size()) beyond -= hist[c];
+            out[c - 1] = cold_misses + beyond;
+        }
+        return out;
+    }
+
+    static StackDistanceEngine replay(const vector<long long> &stream) {
+        StackDistanceEngine e(stream.size());
+        for (long long k : stream) e.access(k);
+        return e;
+    }
+};
+
+// Curva de fallos aproximada por muestreo espacial (estilo SHARDS).
+// Solo se siguen las páginas cuyo hash cae bajo el umbral (fracción rate del espacio de hash);
+// la distancia medida entre páginas muestreadas se escala por 1/rate. La memoria usada es
+// proporcional a rate * páginas distintas, sin importar el largo del flujo, y acepta accesos
+// en línea (access) además de reproducir un registro.
+class ShardsEngine {
+private:
+    static constexpr uint64_t MODULUS = 1ULL << 24;
+    double rate;
+    uint64_t threshold;
+    // árbol de estadísticas de orden sobre el último acceso de cada página muestreada
+    __gnu_pbds::tree<long long, __gnu_pbds::null_type, less<long long>,
+                     __gnu_pbds::rb_tree_tag, __gnu_pbds::tree_order_statistics_node_update> recency;
+    unordered_map<long long,long long> last_time;
+    vector<long long> hist;       // hist[d] = accesos muestreados con distancia escalada d
+    long long cold_misses = 0;
+    long long sampled = 0;
+    long long total = 0;
+
+    static uint64_t mix(uint64_t x) { // splitmix64
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+public:
+    explicit ShardsEngine(double r) : rate(min(1.0, max(r, 1e-6))), hist(1, 0) {
+        threshold = (uint64_t)(rate * MODULUS);
+    }
+
+    void access(long long key) {
+        total++;
+        if (mix((uint64_t)key) % MODULUS >= threshold) return;
+        long long t = sampled++;
+        auto it = last_time.find(key);
+        if (it == last_time.end()) {
+            cold_misses++;
+            last_time.emplace(key, t);
+        } else {
+            // páginas muestreadas distintas tocadas después del acceso anterior, más la propia
+            long long d = (long long)recency.size() - (long long)recency.order_of_key(it->second);
+            long long scaled = llround(d / rate);
+            if ((long long)hist.size() <= scaled) hist.resize(scaled + 1, 0);
+            hist[scaled]++;
+            recency.erase(it->second);
+            it->second = t;
+        }
+        recency.insert(t);
+    }
+
+    long long accesses() const { return total; }
+    long long tracked_pages() const { return (long long)last_time.size(); }
+    double sampling_rate() const { return rate; }
+    // páginas distintas estimadas del flujo completo
+    long long estimated_footprint() const { return llround(tracked_pages() / rate); }
+
+    // fallos estimados con c frames, para c = 1..max_frames (escalados al total de accesos)
+    vector<long long> faults_curve(int max_frames) const {
+        vector<long long> out(max(0, max_frames));
+        if (sampled == 0) return out;
+        long long beyond = 0;
+        for (size_t d = 1; d < hist.size(); ++d) beyond += hist[d];
+        for (int c = 1; c <= max_frames; ++c) {
+            if (c < (int)hist.size()) beyond -= hist[c];
+            out[c - 1] = llround((double)(cold_misses + beyond) / sampled * total);
+        }
+        return out;
+    }
+};
+
+
+// Planificador: RR, SJF no expropiativo, SRTF, MLFQ, CFS, stride y lotería
+
+enum class CPUPolicy { RR, SJF_NONPREEMPTIVE, SRTF, MLFQ, CFS, STRIDE, LOTTERY };
+string cpu_policy_to_str(CPUPolicy p) {
+    switch (p) {
+        case CPUPolicy::RR: return "RR";
+        case CPUPolicy::SJF_NONPREEMPTIVE: return "SJF_nonpreemptive";
+        case CPUPolicy::SRTF: return "SRTF";
+        case CPUPolicy::MLFQ: return "MLFQ";
+        case CPUPolicy::CFS: return "CFS";
+        case CPUPolicy::STRIDE: return "STRIDE";
+        case CPUPolicy::LOTTERY: return "LOTTERY";
+    }
+    return "?";
+}
+
+// Lista doblemente enlazada intrusiva de pids: los enlaces viven en el PCB
+// (rq_prev/rq_next para la cola general, lvl_prev/lvl_next para los niveles MLFQ)
+struct ReadyList {
+    int head = -1, tail = -1;
+    int size = 0;
+};
+
+// Árbol de Fenwick sobre los slots del slab con los boletos de cada proceso READY:
+// el sorteo de lotería y las altas/bajas cuestan O(log n)
+struct TicketTree {
+    vector<long long> bit; // 1-indexado
+    long long total = 0;
+
+    size_t capacity() const { return bit.empty() ? 0 : bit.size() - 1; }
+    void reset(size_t n) { bit.assign(n + 1, 0); total = 0; }
+    void add(int slot, long long v) {
+        total += v;
+        for (int i = slot + 1; i < (int)bit.size(); i += i & -i) bit[i] += v;
+    }
+    // slot del boleto ganador r (0 <= r < total): el primero cuya suma acumulada supera r
+    int find(long long r) const {
+        int pos = 0;
+        for (int step = 1 << (31 - __builtin_clz((unsigned)capacity())); step > 0; step >>= 1)
+            if (pos + step < (int)bit.size() && bit[pos + step] <= r) { pos += step; r -= bit[pos]; }
+        return pos;
+    }
+};
+
+// Estructuras de procesos listos.
+// order contiene todos los READY en orden de llegada a la cola (la cola RR);
+// by_burst indexa los mismos procesos por (rafaga_restante, pid) y solo se mantiene en SJF/SRTF.
+// levels tiene una cola por nivel MLFQ y level_mask un bit por nivel no vacío (solo en MLFQ).
+// by_vruntime es el árbol rojo-negro de CFS, ordenado por (vruntime, pid) (solo en CFS);
+// min_vruntime solo crece y es donde se ubican los que llegan a la cola.
+// by_pass y global_pass son lo mismo para stride con el pase; lottery solo se mantiene en LOTTERY.
+struct RunQueue {
+    ReadyList order;
+    set<pair<int,int>> by_burst;
+    vector<ReadyList> levels;
+    uint64_t level_mask = 0;
+    set<pair<long long,int>> by_vruntime;
+    long long min_vruntime = 0;
+    set<pair<long long,int>> by_pass;
+    long long global_pass = 0;
+    TicketTree lottery;
+};
+
+// Una CPU simulada: su propia cola de listos, el proceso que ejecuta y su contabilidad
+struct CPU {
+    RunQueue rq;
+    optional<int> running_pid;
+    int rr_slice_used = 0;     // Unidades utilizadas en la porción actual
+    long long busy_ticks = 0;  // ticks ejecutando un proceso desde set_cpus
+    long long dispatches = 0;
+    int stall = 0;             // ticks de migración pendientes antes del próximo despacho
+    std::mt19937 rng{12345};   // sorteos de lotería de esta CPU
+
+    // Resultado del último paso de la CPU; tick() lo combina en orden de CPU
+    ostringstream log;         // líneas del log (solo al ejecutar con varios hilos de host)
+    int ran = -1;              // pid que ejecutó, -1 = ninguno
+    bool exited = false;       // ese pid terminó en este tick
+    int io_len = 0;            // > 0: ese pid se bloqueó pidiendo io_len ticks de E/S
+    int new_dispatches = 0, new_preemptions = 0, new_stall_ticks = 0;
+};
+
+// Dispositivo de E/S simulado: atiende una petición a la vez, las demás esperan en FIFO
+struct Device {
+    struct Request { int pid, len; long long since; };
+    deque<Request> queue;
+    int busy_pid = -1;          // proceso atendido, -1 = libre
+    long long busy_since = 0;   // tick en que empezó la petición en curso
+    long long busy_ticks = 0;   // ticks de servicio completados desde set_devices
+    long long completed = 0;
+    long long queue_wait = 0;   // ticks esperados en cola por las peticiones ya atendidas
+};
+
+// Índice de dispositivo del área de intercambio (los de E/S son 0..n-1)
+static const int SWAP_DEVICE = -1;
+
+// Evento futuro del planificador: fin de la petición en curso del dispositivo 'dev' en 'tick'.
+// El heap se ordena por tick y luego por seq (orden de creación), así el orden es determinista.
+struct IOEvent {
+    long long tick;
+    long long seq;
+    int dev;
+    bool operator>(const IOEvent &o) const { return tie(tick, seq) > tie(o.tick, o.seq); }
+};
+
+// Barrera reutilizable para n hilos (C++17 no trae std::barrier)
+class Barrier {
+    mutex m;
+    condition_variable cv;
+    int n, waiting = 0;
+    long long generation = 0;
+
+public:
+    explicit Barrier(int n_) : n(n_) {}
+
+    void arrive_and_wait() {
+        unique_lock<mutex> lk(m);
+        long long g = generation;
+        if (++waiting == n) {
+            waiting = 0;
+            generation++;
+            cv.notify_all();
+            return;
         }
+        cv.wait(lk, [&] { return generation != g; });
     }
 };
 
+// Balanceo de carga entre CPUs: ninguno, robo de trabajo por la CPU ociosa o rebalanceo global periódico
+enum class BalanceMode { NONE, STEAL, PERIODIC };
+string balance_mode_to_str(BalanceMode m) {
+    switch (m) {
+        case BalanceMode::NONE: return "NONE";
+        case BalanceMode::STEAL: return "STEAL";
+        case BalanceMode::PERIODIC: return "PERIODIC";
+    }
+    return "?";
+}
 
-// Planificador (dos algoritmos): RR y SJF no expropiativo
+// Ventana (ticks) de la serie de desbalance que reporta balstat
+static const int IMBALANCE_WINDOW = 100;
 
-enum class CPUPolicy { RR, SJF_NONPREEMPTIVE };
+// Stride: pase por tick de un proceso con un boleto; con t boletos avanza STRIDE1 / t
+static const long long STRIDE1 = 1 << 20;
+static const int MAX_TICKETS = 1 << 20;
+
+// Pesos CFS por nice (-20..19), la misma tabla que usa Linux: cada nivel de nice ~10% de CPU
+static const int nice_to_weight[40] = {
+    88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,  3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,   335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,    36,    29,    23,    18,    15,
+};
+
+// Avance de vruntime por tick de CPU: 1024 unidades para nice 0, inversamente proporcional al peso
+static long long vruntime_delta(int weight) { return (1024LL * 1024 + weight / 2) / weight; }
 
 class Scheduler {
 private:
     CPUPolicy policy;
     int quantum;
-    int current_tick = 0;
+    long long current_tick = 0;  // long long: el modo por eventos puede simular miles de millones de ticks
     int next_pid = 1;
 
-    unordered_map<int, PCB> procs;
-    deque<int> ready_q;          // cola de listos (para RR)
-    // Para SJF, analizaremos los procesos para seleccionar el más corto cuando haya CPU libre.
+    // Tabla de procesos densa: slab[i] e info[i] son el mismo proceso, slot_of[pid] es su
+    // posición. Los pids son secuenciales, así que slot_of es un arreglo;
+    // los slots liberados se reutilizan desde free_slots.
+    // slot_of[pid] == -1: no existe; <= -2: cosechado, en archive[-slot_of[pid] - 2].
+    vector<PCB> slab;
+    vector<PCBInfo> info;
+    vector<int> slot_of{-1};
+    vector<int> free_slots;
+    // Los TERMINATED se cosechan al inicio del siguiente tick (el acceso a memoria del
+    // tick en que terminan aún usa su PCB) y pasan al archivo de solo-agregar.
+    vector<int> pending_reap;
+    vector<ProcessRecord> archive;
+
+    // CPUs simuladas; cada proceso listo está en la cola de una sola (PCB::cpu)
+    vector<CPU> cpus = vector<CPU>(1);
+    long long cpus_since = 0;  // tick desde el que cuentan busy_ticks y las estadísticas de balanceo
+    vector<int> ran;     // pids que ejecutaron en el último tick, en orden de CPU
+
+    // Balanceo: con STEAL una CPU sin trabajo roba la cola de la más cargada si esta tiene al
+    // menos steal_threshold listos; con PERIODIC cada balance_period ticks se igualan las colas.
+    // Cada migración le cuesta migrate_cost ticks a la CPU destino antes de su próximo despacho.
+    BalanceMode balance = BalanceMode::NONE;
+    int steal_threshold = 1;
+    int migrate_cost = 0;
+    int balance_period = 50;
+    long long steals = 0, migrations = 0, stall_ticks = 0;
+    // Desbalance = carga máxima - mínima entre CPUs (carga = en ejecución + en cola), por tick
+    long long imbalance_sum = 0;
+    int imbalance_max = 0;
+    vector<long long> imbalance_hist; // suma del desbalance por ventana de IMBALANCE_WINDOW ticks
+
+    // Configuración MLFQ: asignación (ticks) de cada nivel y periodo del boost de prioridad
+    vector<int> mlfq_quanta{2, 4, 8};
+    int mlfq_boost = 50;
+
+    // CFS: ticks mínimos que corre un proceso antes de poder ser desplazado (reemplaza al quantum)
+    int cfs_min_gran = 2;
+
+    // Semilla de la lotería (independiente de las páginas aleatorias); la CPU i usa lottery_seed + i
+    unsigned lottery_seed = 12345;
+
+    // Ejecución en paralelo: la CPU i la avanza el hilo de host i % hilos (el hilo 0 es el que
+    // llama a tick). Cada paso solo toca la CPU y sus procesos; lo compartido se combina después.
+    int host_threads = 1;
+    vector<thread> workers;
+    unique_ptr<Barrier> phase_start, phase_done;
+    bool workers_stop = false;
+
+    // Dispositivos de E/S y eventos de fin de E/S (min-heap por tick). Los procesos BLOCKED
+    // solo están en la cola o en servicio de un dispositivo; se despiertan al sacar su evento,
+    // sin recorrer los PCBs en cada tick.
+    vector<Device> devices = vector<Device>(1);
+    long long devices_since = 0;
+    // Área de intercambio: con swap_latency > 0 un fallo de página bloquea al proceso ese número
+    // de ticks en este dispositivo (un fallo a la vez, los demás en cola)
+    Device swap;
+    int swap_latency = 0;
+    priority_queue<IOEvent, vector<IOEvent>, greater<IOEvent>> events;
+    long long event_seq = 0;
+
+    // Cambios de contexto: despachos y expropiaciones desde el último set_policy
+    long long dispatches = 0;
+    long long preemptions = 0;
+
+    bool exists(int pid) const { return pid > 0 && pid < (int)slot_of.size() && slot_of[pid] >= 0; }
+    bool archived(int pid) const { return pid > 0 && pid < (int)slot_of.size() && slot_of[pid] <= -2; }
+    PCB &pcb(int pid) { return slab[slot_of[pid]]; }
+    const PCB &pcb(int pid) const { return slab[slot_of[pid]]; }
+    RunQueue &rq_of(int pid) { return cpus[pcb(pid).cpu].rq; }
+
+    int alloc_slot(int pid) {
+        int slot;
+        if (!free_slots.empty()) { slot = free_slots.back(); free_slots.pop_back(); }
+        else { slot = (int)slab.size(); slab.emplace_back(); info.emplace_back(); }
+        if ((int)slot_of.size() <= pid) slot_of.resize(pid + 1, -1);
+        slot_of[pid] = slot;
+        return slot;
+    }
 
-    optional<int> running_pid;
-    int rr_slice_used = 0; // Unidades utilizadas en la porción RR actual
+    // Sufijo de las líneas del log con la CPU; vacío con una sola CPU
+    string cpu_tag(int c) const { return cpus.size() > 1 ? " cpu=" + to_string(c) : ""; }
+
+    // CPU con menos trabajo (en ejecución + en cola); empata la de menor índice
+    int least_loaded_cpu() const {
+        int best = 0, best_load = INT_MAX;
+        for (int c = 0; c < (int)cpus.size(); ++c) {
+            int load = cpus[c].rq.order.size + (cpus[c].running_pid ? 1 : 0);
+            if (load < best_load) { best = c; best_load = load; }
+        }
+        return best;
+    }
+
+    int cpu_load(const CPU &c) const { return c.rq.order.size + (c.running_pid ? 1 : 0); }
+
+    int current_imbalance() const {
+        int lo = INT_MAX, hi = 0;
+        for (const CPU &c : cpus) { lo = min(lo, cpu_load(c)); hi = max(hi, cpu_load(c)); }
+        return hi - lo;
+    }
+
+    // Suma k ticks del desbalance actual a las estadísticas (se llama antes de avanzar el reloj)
+    void account_imbalance(long long k) {
+        int imb = current_imbalance();
+        imbalance_sum += imb * k;
+        if (k > 0) imbalance_max = max(imbalance_max, imb);
+        long long t = current_tick - cpus_since;
+        while (k > 0) {
+            size_t w = t / IMBALANCE_WINDOW;
+            if (imbalance_hist.size() <= w) imbalance_hist.resize(w + 1, 0);
+            long long take = min(k, IMBALANCE_WINDOW - t % IMBALANCE_WINDOW);
+            imbalance_hist[w] += imb * take;
+            t += take;
+            k -= take;
+        }
+    }
+
+    // Mueve el último de la cola de 'from' (el que llegó más tarde) a la cola de 'to'
+    void migrate_tail(int from, int to) {
+        int pid = cpus[from].rq.order.tail;
+        dequeue_ready(pid);
+        pcb(pid).cpu = to;
+        enqueue_ready(pid);
+        migrations++;
+        cpus[to].stall += migrate_cost;
+    }
+
+    // Solo se roba a una CPU ocupada: una CPU libre despacha su propia cola, y la que aún paga
+    // migraciones tiene esa cola en tránsito (evita que dos CPUs ociosas se roben el mismo
+    // proceso indefinidamente)
+    bool can_steal_from(const CPU &v) const {
+        return v.running_pid && v.stall == 0 && v.rq.order.size >= steal_threshold;
+    }
+
+    // Robo de trabajo: la CPU c, sin proceso ni cola, toma la cola de la CPU más cargada
+    void try_steal(int c) {
+        int victim = -1, best = 0;
+        for (int v = 0; v < (int)cpus.size(); ++v) {
+            if (v == c || !can_steal_from(cpus[v])) continue;
+            int q = cpus[v].rq.order.size;
+            if (q > best) { victim = v; best = q; }
+        }
+        if (victim < 0) return;
+        int pid = cpus[victim].rq.order.tail;
+        migrate_tail(victim, c);
+        steals++;
+        cout << "[tick " << current_tick << "] STEAL pid=" << pid << " cpu=" << victim << "->" << c << "\n";
+    }
+
+    // Rebalanceo global: pasa procesos de la cola de la CPU más cargada a la menos cargada
+    // hasta que las cargas difieren en a lo más 1
+    void rebalance_all() {
+        long long moved = 0;
+        while (true) {
+            int hi = 0, lo = 0;
+            for (int c = 1; c < (int)cpus.size(); ++c) {
+                if (cpu_load(cpus[c]) > cpu_load(cpus[hi])) hi = c;
+                if (cpu_load(cpus[c]) < cpu_load(cpus[lo])) lo = c;
+            }
+            if (cpu_load(cpus[hi]) - cpu_load(cpus[lo]) <= 1 || cpus[hi].rq.order.size == 0) break;
+            migrate_tail(hi, lo);
+            moved++;
+        }
+        if (moved) cout << "[tick " << current_tick << "] REBALANCE moved=" << moved << "\n";
+    }
+
+    void mark_terminated(PCB &p, long long fin) {
+        p.estado = Estado::TERMINATED;
+        info[slot_of[p.pid]].fin_tick = fin;
+    }
+
+    // Marca un proceso como TERMINATED y lo deja pendiente de cosecha
+    void terminate(PCB &p, long long fin) {
+        mark_terminated(p, fin);
+        pending_reap.push_back(p.pid);
+    }
+
+    // Pasa un proceso a READY: su espera empieza a contar desde el tick 'since'
+    void become_ready(PCB &p, long long since) {
+        p.estado = Estado::READY;
+        p.ready_since = since;
+        enqueue_ready(p.pid);
+    }
+
+    // Cierra el periodo READY de un proceso al salir de READY en el tick 'now'
+    void leave_ready(PCB &p, long long now) {
+        info[slot_of[p.pid]].espera_acumulada += now - p.ready_since;
+    }
+
+    Device &device(int d) { return d == SWAP_DEVICE ? swap : devices[d]; }
+    const Device &device(int d) const { return d == SWAP_DEVICE ? swap : devices[d]; }
+    string device_name(int d) const { return d == SWAP_DEVICE ? "swap" : to_string(d); }
+
+    // El dispositivo d empieza a atender a pid en el tick 'at'; su fin queda en el heap de eventos
+    void start_io(int d, int pid, int len, long long at) {
+        Device &dev = device(d);
+        dev.busy_pid = pid;
+        dev.busy_since = at;
+        events.push({at + len, event_seq++, d});
+    }
+
+    // Pide len ticks de E/S en el dispositivo d para el proceso bloqueado pid, a partir de 'at'
+    void submit_io(int d, int pid, int len, long long at) {
+        if (device(d).busy_pid < 0) start_io(d, pid, len, at);
+        else device(d).queue.push_back({pid, len, at});
+    }
+
+    // Fin de la petición en curso del dispositivo d en el tick t: despierta al proceso (si no lo
+    // mataron mientras esperaba) y atiende al siguiente vivo de la cola
+    void complete_io(int d, long long t) {
+        Device &dev = device(d);
+        int pid = dev.busy_pid;
+        dev.busy_ticks += t - dev.busy_since;
+        dev.completed++;
+        dev.busy_pid = -1;
+        if (exists(pid) && pcb(pid).estado == Estado::BLOCKED) {
+            PCB &p = pcb(pid);
+            if (p.cpu >= (int)cpus.size()) p.cpu = -1; // su CPU ya no existe (set_cpus)
+            become_ready(p, t);
+            cout << "[tick " << t << "] IO_DONE pid=" << pid << " dev=" << device_name(d) << cpu_tag(p.cpu) << "\n";
+            check_preempt(pid);
+        }
+        while (!dev.queue.empty()) {
+            Device::Request r = dev.queue.front();
+            dev.queue.pop_front();
+            if (!exists(r.pid) || pcb(r.pid).estado != Estado::BLOCKED) continue;
+            dev.queue_wait += t - r.since;
+            start_io(d, r.pid, r.len, t);
+            break;
+        }
+    }
+
+    // Procesa los eventos de E/S que vencen en el tick actual
+    void process_events() {
+        while (!events.empty() && events.top().tick <= current_tick) {
+            IOEvent e = events.top();
+            events.pop();
+            complete_io(e.dev, e.tick);
+        }
+    }
+
+    // Libera la CPU c (el proceso que tenía ya fue movido a otro estado)
+    void vacate(CPU &c) {
+        c.running_pid.reset();
+        c.rr_slice_used = 0;
+    }
+
+    static bool uses_burst_index(CPUPolicy p) {
+        return p == CPUPolicy::SJF_NONPREEMPTIVE || p == CPUPolicy::SRTF;
+    }
+
+    // Expropiación por llegada: en SRTF si el proceso que acaba de quedar listo tiene menos
+    // ráfaga restante que el que está en su CPU; en MLFQ si está en un nivel más prioritario.
+    // El de CPU vuelve a READY y el siguiente tick despacha al elegido por la política.
+    void check_preempt(int pid) {
+        CPU &c = cpus[pcb(pid).cpu];
+        if (!c.running_pid) return;
+        PCB &r = pcb(c.running_pid.value());
+        if (policy == CPUPolicy::SRTF) {
+            if (pcb(pid).rafaga_restante >= r.rafaga_restante) return;
+        } else if (policy == CPUPolicy::MLFQ) {
+            if (pcb(pid).level >= r.level) return;
+        } else {
+            return;
+        }
+        become_ready(r, current_tick);
+        preemptions++;
+        cout << "[tick " << current_tick << "] PREEMPT pid=" << r.pid << " by pid=" << pid << cpu_tag(r.cpu) << "\n";
+        vacate(c);
+    }
+
+    // Operaciones de lista; prev/next eligen qué par de enlaces del PCB se usa
+    void list_push_back(ReadyList &l, int pid, int PCB::*prev = &PCB::rq_prev, int PCB::*next = &PCB::rq_next) {
+        PCB &p = pcb(pid);
+        p.*prev = l.tail;
+        p.*next = -1;
+        if (l.tail != -1) pcb(l.tail).*next = pid; else l.head = pid;
+        l.tail = pid;
+        l.size++;
+    }
+
+    void list_remove(ReadyList &l, int pid, int PCB::*prev = &PCB::rq_prev, int PCB::*next = &PCB::rq_next) {
+        PCB &p = pcb(pid);
+        if (p.*prev != -1) pcb(p.*prev).*next = p.*next; else l.head = p.*next;
+        if (p.*next != -1) pcb(p.*next).*prev = p.*prev; else l.tail = p.*prev;
+        p.*prev = p.*next = -1;
+        l.size--;
+    }
+
+    // Encola en su nivel MLFQ. El nivel se ajusta a la configuración actual: un proceso que
+    // estaba bloqueado al reconfigurar MLFQ puede traer un nivel que ya no existe.
+    void level_push(int pid) {
+        RunQueue &rq = rq_of(pid);
+        PCB &p = pcb(pid);
+        p.level = min(p.level, (int)mlfq_quanta.size() - 1);
+        int lv = p.level;
+        list_push_back(rq.levels[lv], pid, &PCB::lvl_prev, &PCB::lvl_next);
+        rq.level_mask |= 1ULL << lv;
+    }
+
+    void level_remove(int pid) {
+        RunQueue &rq = rq_of(pid);
+        int lv = pcb(pid).level;
+        list_remove(rq.levels[lv], pid, &PCB::lvl_prev, &PCB::lvl_next);
+        if (rq.levels[lv].size == 0) rq.level_mask &= ~(1ULL << lv);
+    }
+
+    // Rearma las colas MLFQ a partir de la cola general (al activar o reconfigurar MLFQ)
+    void rebuild_levels(RunQueue &rq) {
+        rq.levels.assign(mlfq_quanta.size(), ReadyList());
+        rq.level_mask = 0;
+        for (int pid = rq.order.head; pid != -1; pid = pcb(pid).rq_next) level_push(pid);
+    }
+
+    // Boost periódico: todos los procesos vuelven al nivel más prioritario
+    void mlfq_boost_all() {
+        for (CPU &c : cpus) {
+            RunQueue &rq = c.rq;
+            if (!rq.levels.empty())
+                for (int pid = rq.levels[0].head; pid != -1; pid = pcb(pid).lvl_next) pcb(pid).level_used = 0;
+            for (size_t lv = 1; lv < rq.levels.size(); ++lv) {
+                while (rq.levels[lv].head != -1) {
+                    int pid = rq.levels[lv].head;
+                    level_remove(pid);
+                    pcb(pid).level = 0;
+                    pcb(pid).level_used = 0;
+                    level_push(pid);
+                }
+            }
+            if (c.running_pid) {
+                pcb(c.running_pid.value()).level = 0;
+                pcb(c.running_pid.value()).level_used = 0;
+            }
+        }
+        // los bloqueados están todos en algún dispositivo (en servicio o en cola)
+        auto boost_blocked = [&](int pid) {
+            if (!exists(pid) || pcb(pid).estado != Estado::BLOCKED) return;
+            pcb(pid).level = 0;
+            pcb(pid).level_used = 0;
+        };
+        for (int i = SWAP_DEVICE; i < (int)devices.size(); ++i) {
+            boost_blocked(device(i).busy_pid);
+            for (const Device::Request &r : device(i).queue) boost_blocked(r.pid);
+        }
+        cout << "[tick " << current_tick << "] BOOST\n";
+    }
+
+    // Inserta en un árbol de tiempo virtual (CFS: vruntime; stride: pass). 'floor' sigue al
+    // menor valor entre el proceso en CPU y el primero del árbol, y solo crece. Quien llega
+    // (o estuvo fuera de la cola) no arrastra un valor atrasado: empieza en 'floor' para no
+    // acaparar la CPU.
+    void virtual_insert(PCB &p, long long PCB::*key, set<pair<long long,int>> &tree, long long &floor) {
+        long long m = LLONG_MAX;
+        const CPU &c = cpus[p.cpu];
+        if (c.running_pid) m = pcb(c.running_pid.value()).*key;
+        if (!tree.empty()) m = min(m, tree.begin()->first);
+        if (m != LLONG_MAX) floor = max(floor, m);
+        p.*key = max(p.*key, floor);
+        tree.insert({p.*key, p.pid});
+    }
+
+    void cfs_insert(PCB &p) {
+        RunQueue &rq = cpus[p.cpu].rq;
+        virtual_insert(p, &PCB::vruntime, rq.by_vruntime, rq.min_vruntime);
+    }
+    void stride_insert(PCB &p) {
+        RunQueue &rq = cpus[p.cpu].rq;
+        virtual_insert(p, &PCB::pass, rq.by_pass, rq.global_pass);
+    }
+
+    // Rearma el árbol de boletos con los READY actuales; crece al doble del slab
+    void rebuild_lottery(RunQueue &rq) {
+        rq.lottery.reset(max<size_t>(64, 2 * slab.size()));
+        for (int pid = rq.order.head; pid != -1; pid = pcb(pid).rq_next)
+            rq.lottery.add(slot_of[pid], pcb(pid).tickets);
+    }
+
+    void lottery_insert(int pid) {
+        RunQueue &rq = rq_of(pid);
+        if (rq.lottery.capacity() < slab.size()) rebuild_lottery(rq); // ya incluye a pid
+        else rq.lottery.add(slot_of[pid], pcb(pid).tickets);
+    }
+
+    // Porción del reparto pedida por el proceso: boletos en stride/lotería, peso en el resto
+    int share_weight(const PCB &p) const {
+        return policy == CPUPolicy::STRIDE || policy == CPUPolicy::LOTTERY ? p.tickets : p.weight;
+    }
+
+    // Políticas que expropian al agotar un quantum fijo
+    bool uses_quantum() const {
+        return policy == CPUPolicy::RR || policy == CPUPolicy::STRIDE || policy == CPUPolicy::LOTTERY;
+    }
+
+    // Agrega un proceso READY a la cola de su CPU (O(1), O(log n) en SJF y CFS);
+    // un proceso sin CPU va a la menos cargada
+    void enqueue_ready(int pid) {
+        PCB &p = pcb(pid);
+        if (p.in_ready) return;
+        p.in_ready = true;
+        if (p.cpu < 0) p.cpu = least_loaded_cpu();
+        RunQueue &rq = cpus[p.cpu].rq;
+        list_push_back(rq.order, pid);
+        if (uses_burst_index(policy)) rq.by_burst.insert({p.rafaga_restante, pid});
+        if (policy == CPUPolicy::MLFQ) level_push(pid);
+        if (policy == CPUPolicy::CFS) cfs_insert(p);
+        if (policy == CPUPolicy::STRIDE) stride_insert(p);
+        if (policy == CPUPolicy::LOTTERY) lottery_insert(pid);
+    }
+
+    // Quita un proceso de la estructura de listos (si está)
+    void dequeue_ready(int pid) {
+        PCB &p = pcb(pid);
+        if (!p.in_ready) return;
+        p.in_ready = false;
+        RunQueue &rq = cpus[p.cpu].rq;
+        list_remove(rq.order, pid);
+        if (uses_burst_index(policy)) rq.by_burst.erase({p.rafaga_restante, pid});
+        if (policy == CPUPolicy::MLFQ) level_remove(pid);
+        if (policy == CPUPolicy::CFS) rq.by_vruntime.erase({p.vruntime, pid});
+        if (policy == CPUPolicy::STRIDE) rq.by_pass.erase({p.pass, pid});
+        if (policy == CPUPolicy::LOTTERY) rq.lottery.add(slot_of[pid], -p.tickets);
+    }
+
+    // Ticks hasta la próxima expropiación CFS del proceso en CPU (a partir de 1):
+    // debe cumplir la granularidad mínima y quedar con más vruntime que el primero del árbol
+    int cfs_ticks_to_preempt(const CPU &c, const PCB &p) const {
+        if (c.rq.by_vruntime.empty()) return INT_MAX;
+        long long d = vruntime_delta(p.weight);
+        long long left = c.rq.by_vruntime.begin()->first;
+        long long pass = left < p.vruntime ? 1 : (left - p.vruntime) / d + 1;
+        return (int)min<long long>(INT_MAX, max<long long>(pass, cfs_min_gran - c.rr_slice_used));
+    }
+
+    // Selecciona el siguiente proceso de la cola de la CPU c
+    optional<int> schedule_next(int c) {
+        RunQueue &rq = cpus[c].rq;
+        int pid;
+        if (policy == CPUPolicy::RR) {
+            if (rq.order.head == -1) return {};
+            pid = rq.order.head;
+        } else if (policy == CPUPolicy::MLFQ) {
+            // cabeza del nivel no vacío más prioritario
+            if (rq.level_mask == 0) return {};
+            pid = rq.levels[__builtin_ctzll(rq.level_mask)].head;
+        } else if (policy == CPUPolicy::CFS) {
+            // el de menor vruntime es el extremo izquierdo del árbol
+            if (rq.by_vruntime.empty()) return {};
+            pid = rq.by_vruntime.begin()->second;
+        } else if (policy == CPUPolicy::STRIDE) {
+            // menor pase
+            if (rq.by_pass.empty()) return {};
+            pid = rq.by_pass.begin()->second;
+        } else if (policy == CPUPolicy::LOTTERY) {
+            // sorteo ponderado por boletos
+            if (rq.lottery.total == 0) return {};
+            std::uniform_int_distribution<long long> draw(0, rq.lottery.total - 1);
+            pid = slab[rq.lottery.find(draw(cpus[c].rng))].pid;
+        } else { // SJF no expropiativo y SRTF
+            // el proceso READY con el rafaga_restante más pequeño está al inicio del conjunto
+            if (rq.by_burst.empty()) return {};
+            pid = rq.by_burst.begin()->second;
+        }
+        dequeue_ready(pid);
+        return pid;
+    }
+
+    // Un tick de la CPU c: despacha si está libre y ejecuta 1 unidad del proceso en CPU.
+    // Solo modifica la CPU c y sus procesos (puede correr en paralelo con las demás CPUs);
+    // el log va a 'out' y los contadores globales quedan en c.new_* para tick().
+    void step_cpu(int ci, ostream &out) {
+        CPU &c = cpus[ci];
+        c.ran = -1;
+        c.exited = false;
+        c.io_len = 0;
+        c.new_dispatches = c.new_preemptions = c.new_stall_ticks = 0;
+        // la CPU paga las migraciones recibidas antes de despachar
+        if (!c.running_pid && c.stall > 0) {
+            c.stall--;
+            c.new_stall_ticks++;
+            return;
+        }
+        // si no hay proceso corriendo, planifica uno
+        if (!c.running_pid) {
+            auto next = schedule_next(ci);
+            if (next) {
+                c.running_pid = next.value();
+                auto &p = pcb(next.value());
+                leave_ready(p, current_tick);
+                p.estado = Estado::RUNNING;
+                auto &pi = info[slot_of[p.pid]];
+                if (pi.inicio_tick == -1) pi.inicio_tick = current_tick;
+                c.rr_slice_used = 0;
+                c.dispatches++;
+                c.new_dispatches++;
+                out << "[tick " << current_tick << "] SCHEDULE pid=" << p.pid << cpu_tag(ci) << "\n";
+            }
+        }
+
+        // la espera de los procesos READY se contabiliza al salir de READY (ver leave_ready)
+
+        if (!c.running_pid) return;
+        int pid = c.running_pid.value();
+        c.ran = pid;
+        c.busy_ticks++;
+        auto &p = pcb(pid);
+        // ejecutar 1 unidad
+        p.rafaga_restante--;
+        if (policy == CPUPolicy::CFS) p.vruntime += vruntime_delta(p.weight);
+        if (policy == CPUPolicy::STRIDE) p.pass += STRIDE1 / p.tickets;
+        if (log_runs) out << "[tick " << current_tick << "] RUN pid=" << pid << " rem=" << p.rafaga_restante << cpu_tag(ci) << "\n";
+        // fin de la ráfaga de CPU: si sigue una de E/S se bloquea (tick() la envía al dispositivo)
+        auto &pi = info[slot_of[pid]];
+        if (p.rafaga_restante <= 0 && pi.io_next < (int)pi.io.size()) {
+            auto [len, next_burst] = pi.io[pi.io_next++];
+            p.estado = Estado::BLOCKED;
+            p.rafaga_restante = next_burst;
+            c.io_len = len;
+            out << "[tick " << current_tick << "] BLOCKED pid=" << pid << " io=" << len
+                << " dev=" << pi.device << cpu_tag(ci) << "\n";
+            vacate(c);
+            return;
+        }
+        // verifica terminación
+        if (p.rafaga_restante <= 0) {
+            mark_terminated(p, current_tick + 1); // finaliza al final de este ciclo
+            c.exited = true;
+            out << "[tick " << current_tick << "] EXIT pid=" << pid << cpu_tag(ci) << "\n";
+            vacate(c);
+            return;
+        }
+        // si RR (o stride/lotería), verifica el quantum
+        if (uses_quantum()) {
+            if (++c.rr_slice_used >= quantum) {
+                // expropiación: vuelve a esperar desde el próximo tick
+                become_ready(p, current_tick + 1);
+                c.new_preemptions++;
+                out << "[tick " << current_tick << "] PREEMPT pid=" << pid << cpu_tag(ci) << "\n";
+                vacate(c);
+            }
+        } else if (policy == CPUPolicy::CFS) {
+            // cumplida la granularidad, cede la CPU si otro quedó con menos vruntime
+            if (++c.rr_slice_used >= cfs_min_gran && !c.rq.by_vruntime.empty()
+                && c.rq.by_vruntime.begin()->first < p.vruntime) {
+                become_ready(p, current_tick + 1);
+                c.new_preemptions++;
+                out << "[tick " << current_tick << "] PREEMPT pid=" << pid << " vruntime=" << p.vruntime << cpu_tag(ci) << "\n";
+                vacate(c);
+            }
+        } else if (policy == CPUPolicy::MLFQ) {
+            // agotó la asignación de su nivel: baja un nivel
+            c.rr_slice_used++;
+            if (++p.level_used >= mlfq_quanta[p.level]) {
+                p.level = min(p.level + 1, (int)mlfq_quanta.size() - 1);
+                p.level_used = 0;
+                become_ready(p, current_tick + 1);
+                c.new_preemptions++;
+                out << "[tick " << current_tick << "] PREEMPT pid=" << pid << " level=" << p.level << cpu_tag(ci) << "\n";
+                vacate(c);
+            }
+        }
+    }
+
+    // Avanza todas las CPUs un paso: en orden en este hilo, o repartidas entre los hilos de
+    // host con una barrera al inicio y otra al final
+    void step_all() {
+        if (workers.empty()) {
+            for (int c = 0; c < (int)cpus.size(); ++c) step_cpu(c, cout);
+            return;
+        }
+        // con la salida silenciada (benchmarks) los buffers tampoco formatean
+        for (CPU &c : cpus) c.log.clear(cout.rdstate() & ios::badbit);
+        int t = (int)workers.size() + 1;
+        phase_start->arrive_and_wait();
+        for (int c = 0; c < (int)cpus.size(); c += t) step_cpu(c, cpus[c].log);
+        phase_done->arrive_and_wait();
+        for (CPU &c : cpus) {
+            cout << c.log.str();
+            c.log.str("");
+        }
+    }
+
+    void worker_loop(int t) {
+        while (true) {
+            phase_start->arrive_and_wait();
+            if (workers_stop) return;
+            int n = (int)workers.size() + 1;
+            for (int c = t; c < (int)cpus.size(); c += n) step_cpu(c, cpus[c].log);
+            phase_done->arrive_and_wait();
+        }
+    }
+
+    void start_workers() {
+        int t = min(host_threads, (int)cpus.size());
+        if (t <= 1) return;
+        phase_start = make_unique<Barrier>(t);
+        phase_done = make_unique<Barrier>(t);
+        for (int i = 1; i < t; ++i) workers.emplace_back(&Scheduler::worker_loop, this, i);
+    }
+
+    void stop_workers() {
+        if (workers.empty()) return;
+        workers_stop = true;
+        phase_start->arrive_and_wait();
+        for (thread &w : workers) w.join();
+        workers.clear();
+        workers_stop = false;
+    }
+
+    // Ticks que la CPU c puede ejecutar sin eventos del planificador (ver quiet_ticks)
+    int cpu_quiet_ticks(const CPU &c) const {
+        const PCB &p = pcb(c.running_pid.value());
+        int left = p.rafaga_restante - 1;
+        if (uses_quantum()) left = min(left, quantum - c.rr_slice_used - 1);
+        if (policy == CPUPolicy::MLFQ) {
+            left = min(left, mlfq_quanta[p.level] - p.level_used - 1);
+            // el tick del boost tampoco se puede saltar
+            if (mlfq_boost > 0) left = min(left, (int)((mlfq_boost - current_tick % mlfq_boost) % mlfq_boost));
+        }
+        if (policy == CPUPolicy::CFS) left = min(left, cfs_ticks_to_preempt(c, p) - 1);
+        return max(0, left);
+    }
+
+    bool log_runs = true;  // imprimir una línea RUN por tick (el modo por eventos la omite)
 
 public:
     Scheduler(CPUPolicy p = CPUPolicy::RR, int q=2): policy(p), quantum(q) {}
+    ~Scheduler() { stop_workers(); }
 
     // crea el proceso
-    int create_process(int burst, int npages = 4, const vector<int> &trace = {}) {
+    // io: ráfagas (E/S, CPU) que siguen a la primera ráfaga de CPU; device: dispositivo de esas E/S
+    int create_process(int burst, int npages = 4, const vector<int> &trace = {}, int nice = 0, int tickets = 100,
+                       const vector<pair<int,int>> &io = {}, int device = 0) {
+        reap();
         int pid = next_pid++;
-        PCB pcb(pid, burst, current_tick, npages);
-        if (!trace.empty()) pcb.trace = trace;
-        pcb.estado = Estado::READY;
-        procs[pid] = pcb;
-        ready_q.push_back(pid);
-        cout << "[tick " << current_tick << "] CREATED pid=" << pid << " burst=" << burst << " pages=" << npages << "\n";
+        int slot = alloc_slot(pid);
+        nice = min(max(nice, -20), 19);
+        slab[slot] = PCB(pid, burst, current_tick);
+        slab[slot].weight = nice_to_weight[nice + 20];
+        slab[slot].tickets = min(max(tickets, 1), MAX_TICKETS);
+        info[slot] = PCBInfo(burst, current_tick, npages);
+        info[slot].nice = nice;
+        for (auto [len, next_burst] : io) {
+            info[slot].io.push_back({max(1, len), max(1, next_burst)});
+            info[slot].rafaga_total += max(1, next_burst);
+        }
+        info[slot].device = min(max(0, device), (int)devices.size() - 1); // el CLI ya valida el rango
+        if (!trace.empty()) {
+            info[slot].trace = trace;
+            info[slot].trace_next = compute_next_use(trace, npages);
+        }
+        slab[slot].estado = Estado::READY;
+        enqueue_ready(pid);
+        cout << "[tick " << current_tick << "] CREATED pid=" << pid << " burst=" << burst << " pages=" << npages;
+        if (!io.empty()) cout << " io_bursts=" << io.size();
+        cout << cpu_tag(slab[slot].cpu) << "\n";
+        check_preempt(pid);
         return pid;
     }
 
-    // "mata" el proceso
-    void kill_process(int pid) {
-        if (procs.find(pid) == procs.end()) { cout << "pid not found\n"; return; }
-        auto &p = procs[pid];
-        p.estado = Estado::TERMINATED;
-        p.fin_tick = current_tick;
-    // Eliminar de ready_q si está presente
-        ready_q.erase(remove(ready_q.begin(), ready_q.end(), pid), ready_q.end());
-        if (running_pid && running_pid.value() == pid) {
-            running_pid.reset();
-            rr_slice_used = 0;
+    // "mata" el proceso; retorna false si el pid no existe o ya terminó
+    bool kill_process(int pid) {
+        if (archived(pid)) { cout << "pid already terminated\n"; return false; }
+        if (!exists(pid)) { cout << "pid not found\n"; return false; }
+        auto &p = pcb(pid);
+        if (p.estado == Estado::TERMINATED) { cout << "pid already terminated\n"; return false; }
+    // Eliminar de la estructura de listos si está presente
+        if (p.estado == Estado::READY) {
+            dequeue_ready(pid);
+            leave_ready(p, current_tick);
         }
+        if (p.estado == Estado::RUNNING) vacate(cpus[p.cpu]);
+        terminate(p, current_tick);
         cout << "[tick " << current_tick << "] KILLED pid=" << pid << "\n";
+        return true;
     }
 
     // cambia politica de la CPU
     void set_policy(CPUPolicy p, int q = 2) {
+        for (CPU &c : cpus) {
+            // restablecer el estado de tiempo de ejecución: el proceso en CPU vuelve a READY
+            if (c.running_pid) become_ready(pcb(c.running_pid.value()), current_tick);
+            vacate(c);
+            // la cola en orden de llegada se conserva; el índice SJF se arma o descarta
+            RunQueue &rq = c.rq;
+            if (uses_burst_index(p) && !uses_burst_index(policy)) {
+                for (int pid = rq.order.head; pid != -1; pid = pcb(pid).rq_next)
+                    rq.by_burst.insert({pcb(pid).rafaga_restante, pid});
+            } else if (!uses_burst_index(p)) {
+                rq.by_burst.clear();
+            }
+        }
         policy = p;
         quantum = q;
-        // restablecer el estado de tiempo de ejecución
-        running_pid.reset();
-        rr_slice_used = 0;
-        cout << "Scheduler set to " << (policy==CPUPolicy::RR ? "RR" : "SJF_nonpreemptive") << " quantum=" << quantum << "\n";
+        if (policy == CPUPolicy::CFS) cfs_min_gran = max(1, q);
+        for (CPU &c : cpus) {
+            RunQueue &rq = c.rq;
+            if (policy == CPUPolicy::MLFQ) rebuild_levels(rq);
+            else { rq.levels.clear(); rq.level_mask = 0; }
+            rq.by_vruntime.clear();
+            rq.by_pass.clear();
+            rq.lottery.reset(0);
+            if (policy == CPUPolicy::CFS)
+                for (int pid = rq.order.head; pid != -1; pid = pcb(pid).rq_next) cfs_insert(pcb(pid));
+            if (policy == CPUPolicy::STRIDE)
+                for (int pid = rq.order.head; pid != -1; pid = pcb(pid).rq_next) stride_insert(pcb(pid));
+            if (policy == CPUPolicy::LOTTERY) rebuild_lottery(rq);
+        }
+        dispatches = preemptions = 0;
+        cout << "Scheduler set to " << cpu_policy_to_str(policy) << " quantum=" << quantum << "\n";
+        if (policy == CPUPolicy::MLFQ) {
+            cout << "MLFQ levels=" << mlfq_quanta.size() << " quanta=";
+            for (size_t i = 0; i < mlfq_quanta.size(); ++i) cout << (i ? "," : "") << mlfq_quanta[i];
+            cout << " boost=" << mlfq_boost << "\n";
+        }
+    }
+
+    // Cambia el número de CPUs: los procesos en CPU vuelven a READY y todos los listos se
+    // reparten de nuevo, en orden, hacia la CPU menos cargada. Reinicia la contabilidad por CPU.
+    void set_cpus(int n) {
+        n = max(1, n);
+        vector<int> pending;
+        for (CPU &c : cpus) {
+            if (c.running_pid) become_ready(pcb(c.running_pid.value()), current_tick);
+            vacate(c);
+        }
+        for (CPU &c : cpus)
+            for (int pid = c.rq.order.head; pid != -1; pid = pcb(pid).rq_next) pending.push_back(pid);
+        for (int pid : pending) dequeue_ready(pid);
+        stop_workers();
+        cpus.clear();
+        cpus.resize(n);
+        for (int i = 0; i < n; ++i) cpus[i].rng.seed(lottery_seed + i);
+        start_workers();
+        if (policy == CPUPolicy::MLFQ)
+            for (CPU &c : cpus) rebuild_levels(c.rq);
+        for (int pid : pending) {
+            pcb(pid).cpu = -1;
+            enqueue_ready(pid);
+        }
+        reset_balance_stats();
+        cout << "CPUs = " << n << "\n";
+    }
+
+    // Configura el balanceo entre CPUs. STEAL: param = umbral de robo; PERIODIC: param = periodo
+    void set_balance(BalanceMode m, int param, int cost) {
+        balance = m;
+        if (m == BalanceMode::STEAL) steal_threshold = max(1, param);
+        if (m == BalanceMode::PERIODIC) balance_period = max(1, param);
+        migrate_cost = max(0, cost);
+        reset_balance_stats();
+        cout << "Balance = " << balance_mode_to_str(m);
+        if (m == BalanceMode::STEAL) cout << " threshold=" << steal_threshold;
+        if (m == BalanceMode::PERIODIC) cout << " period=" << balance_period;
+        cout << " migrate_cost=" << migrate_cost << "\n";
+    }
+
+    void reset_balance_stats() {
+        cpus_since = current_tick;
+        for (CPU &c : cpus) { c.busy_ticks = 0; c.dispatches = 0; }
+        steals = migrations = stall_ticks = imbalance_sum = 0;
+        imbalance_max = 0;
+        imbalance_hist.clear();
     }
 
+    long long get_steals() const { return steals; }
+    long long get_migrations() const { return migrations; }
+    double avg_imbalance() const {
+        long long span = current_tick - cpus_since;
+        return span ? (double)imbalance_sum / span : 0.0;
+    }
+
+    // Robos, migraciones y desbalance en el tiempo (promedio por ventana, últimas 20 ventanas)
+    void balance_stats() const {
+        cout << "Balance " << balance_mode_to_str(balance) << " cpus=" << cpus.size()
+             << " steals=" << steals << " migrations=" << migrations << " stall_ticks=" << stall_ticks << "\n";
+        cout << "Imbalance avg=" << fixed << setprecision(3) << avg_imbalance() << defaultfloat
+             << " max=" << imbalance_max << " now=" << current_imbalance() << "\n";
+        long long span = current_tick - cpus_since;
+        size_t first = imbalance_hist.size() > 20 ? imbalance_hist.size() - 20 : 0;
+        cout << "TICKS\tAVG_IMBALANCE\n";
+        for (size_t w = first; w < imbalance_hist.size(); ++w) {
+            long long a = cpus_since + (long long)w * IMBALANCE_WINDOW;
+            long long len = min<long long>(IMBALANCE_WINDOW, span - (long long)w * IMBALANCE_WINDOW);
+            cout << a << "-" << a + len - 1 << "\t" << fixed << setprecision(3)
+                 << (len ? (double)imbalance_hist[w] / len : 0.0) << defaultfloat << "\n";
+        }
+    }
+
+    int num_cpus() const { return (int)cpus.size(); }
+    int num_devices() const { return (int)devices.size(); }
+
+    // Configura MLFQ (hasta 64 niveles); se aplica con set_policy(CPUPolicy::MLFQ)
+    void configure_mlfq(const vector<int> &quanta, int boost_period) {
+        mlfq_quanta = quanta;
+        if (mlfq_quanta.empty()) mlfq_quanta = {2, 4, 8};
+        if (mlfq_quanta.size() > 64) mlfq_quanta.resize(64);
+        for (int &q : mlfq_quanta) q = max(1, q);
+        mlfq_boost = max(0, boost_period);
+    }
+
+    void seed_lottery(unsigned sd) {
+        lottery_seed = sd;
+        for (int i = 0; i < (int)cpus.size(); ++i) cpus[i].rng.seed(sd + i);
+    }
+
+    // Número de hilos de host que avanzan las CPUs en cada tick (a lo más uno por CPU).
+    // La salida es idéntica a la secuencial: cada CPU escribe en su buffer y todo se combina
+    // en orden de CPU.
+    void set_host_threads(int t) {
+        stop_workers();
+        host_threads = max(1, t);
+        start_workers();
+    }
+
+    int get_host_threads() const { return (int)workers.size() + 1; }
+
     CPUPolicy get_policy() const { return policy; }
 
-    // Función auxiliar para seleccionar el siguiente proceso cuando haya CPU libre
-    optional<int> schedule_next() {
-        if (policy == CPUPolicy::RR) {
-            if (!running_pid && !ready_q.empty()) {
-                int pid = ready_q.front(); ready_q.pop_front();
-                return pid;
-            }
-            return {};
-        } else { // SJF no expropiativo
-            // elige el proceso READY con el rafaga_restante más pequeño
-            int best = -1;
-            int best_burst = INT_MAX;
-            for (auto &kv : procs) {
-                auto &p = kv.second;
-                if (p.estado == Estado::READY) {
-                    if (p.rafaga_restante < best_burst) {
-                        best_burst = p.rafaga_restante;
-                        best = p.pid;
-                    }
-                }
-            }
-            if (best != -1) {
-                // Eliminar "best" del contenedor de la lista de READY (ready_q aún podría contenerlo)
-                ready_q.erase(remove(ready_q.begin(), ready_q.end(), best), ready_q.end());
-                return best;
-            }
-            return {};
+    // Avanza un tick en todas las CPUs, en orden; retorna los pids que ejecutaron (en orden de CPU)
+    const vector<int> &tick() {
+        reap();
+        ran.clear();
+        process_events();
+        if (policy == CPUPolicy::MLFQ && mlfq_boost > 0 && current_tick > 0 && current_tick % mlfq_boost == 0)
+            mlfq_boost_all();
+        if (balance == BalanceMode::PERIODIC && cpus.size() > 1 && current_tick > 0 && current_tick % balance_period == 0)
+            rebalance_all();
+        // los robos se deciden antes del paso, con el estado del inicio del tick
+        if (balance == BalanceMode::STEAL)
+            for (int c = 0; c < (int)cpus.size(); ++c)
+                if (!cpus[c].running_pid && cpus[c].rq.order.size == 0) try_steal(c);
+        step_all();
+        // combinación en orden de CPU
+        for (CPU &c : cpus) {
+            if (c.ran >= 0) ran.push_back(c.ran);
+            if (c.exited) pending_reap.push_back(c.ran);
+            if (c.io_len > 0) submit_io(process_info(c.ran).device, c.ran, c.io_len, current_tick + 1);
+            dispatches += c.new_dispatches;
+            preemptions += c.new_preemptions;
+            stall_ticks += c.new_stall_ticks;
         }
+        account_imbalance(1);
+        current_tick++;
+        return ran;
     }
 
-    // Avanza un tick: ejecuta 1 unidad si hay proceso corriendo
-    optional<int> tick() {
-        // si no hay proceso corriendo, planifica uno
-        if (!running_pid) {
-            auto next = schedule_next();
-            if (next) {
-                running_pid = next.value();
-                auto &p = procs[running_pid.value()];
-                p.estado = Estado::RUNNING;
-                if (p.inicio_tick == -1) p.inicio_tick = current_tick;
-                rr_slice_used = 0;
-                cout << "[tick " << current_tick << "] SCHEDULE pid=" << running_pid.value() << "\n";
-            }
+    // Ticks que pueden pasar sin eventos del planificador (ni fin de ráfaga, de quantum o de E/S)
+    // ejecutando los procesos en CPU; 0 si ninguna CPU ejecuta o alguna libre tiene cola
+    long long quiet_ticks() const {
+        long long best = LLONG_MAX;
+        int running = 0;
+        bool stealable = false;
+        for (const CPU &c : cpus) {
+            if (c.running_pid) { running++; best = min<long long>(best, cpu_quiet_ticks(c)); }
+            else if (c.rq.order.size > 0 || c.stall > 0) return 0;
+            if (can_steal_from(c)) stealable = true;
         }
+        if (!running) return 0;
+        // una CPU libre robaría en el próximo tick
+        if (balance == BalanceMode::STEAL && stealable && running < (int)cpus.size()) return 0;
+        if (balance == BalanceMode::PERIODIC && cpus.size() > 1)
+            best = min<long long>(best, (balance_period - current_tick % balance_period) % balance_period);
+        return min(best, ticks_to_next_event());
+    }
 
-        // incrementar tiempo de espera para procesos en READY
-        for (auto &kv : procs) {
-            auto &p = kv.second;
-            if (p.estado == Estado::READY) p.espera_acumulada++;
-        }
-
-        optional<int> ran_pid = {};
-        if (running_pid) {
-            int pid = running_pid.value();
-            ran_pid = pid;
-            auto &p = procs[pid];
-            // ejecutar 1 unidad
-            p.rafaga_restante--;
-            cout << "[tick " << current_tick << "] RUN pid=" << pid << " rem=" << p.rafaga_restante << "\n";
-            // verifica terminación
-            if (p.rafaga_restante <= 0) {
-                p.estado = Estado::TERMINATED;
-                p.fin_tick = current_tick + 1; // finaliza al final de este ciclo
-                cout << "[tick " << current_tick << "] EXIT pid=" << pid << "\n";
-                running_pid.reset();
-                rr_slice_used = 0;
-            } else {
-                // si RR, verifica el quantum
-                if (policy == CPUPolicy::RR) {
-                    rr_slice_used++;
-                    if (rr_slice_used >= quantum) {
-                        // expropiación
-                        p.estado = Estado::READY;
-                        ready_q.push_back(pid);
-                        cout << "[tick " << current_tick << "] PREEMPT pid=" << pid << "\n";
-                        running_pid.reset();
-                        rr_slice_used = 0;
-                    }
-                } else {
-                    }
-            }
+    // Avanza k ticks de ejecución de los procesos en CPU de una vez (k <= quiet_ticks())
+    void advance_running(long long k) {
+        for (CPU &c : cpus) {
+            if (!c.running_pid) continue;
+            auto &p = pcb(c.running_pid.value());
+            p.rafaga_restante -= k;
+            c.busy_ticks += k;
+            if (policy != CPUPolicy::SJF_NONPREEMPTIVE && policy != CPUPolicy::SRTF) c.rr_slice_used += k;
+            if (policy == CPUPolicy::MLFQ) p.level_used += k;
+            if (policy == CPUPolicy::CFS) p.vruntime += k * vruntime_delta(p.weight);
+            if (policy == CPUPolicy::STRIDE) p.pass += k * (STRIDE1 / p.tickets);
         }
+        account_imbalance(k);
+        current_tick += k;
+    }
 
-        current_tick++;
-        return ran_pid;
+    // No hay procesos en CPU ni listos: el tiempo puede avanzar de un salto (ver idle_quiet_ticks)
+    bool idle() const {
+        for (const CPU &c : cpus)
+            if (c.running_pid || c.rq.order.size > 0 || c.stall > 0) return false;
+        return true;
     }
 
+    // Ticks hasta el próximo fin de E/S (LLONG_MAX si no hay E/S en curso)
+    long long ticks_to_next_event() const {
+        return events.empty() ? LLONG_MAX : max(0LL, events.top().tick - current_tick);
+    }
+
+    bool io_pending() const { return !events.empty(); }
+
+    // Ticks que puede saltar el sistema ocioso (ver idle): hasta el próximo fin de E/S y, en
+    // MLFQ con E/S en curso, hasta el próximo boost, que también sube a los bloqueados
+    long long idle_quiet_ticks() const {
+        long long k = ticks_to_next_event();
+        if (policy == CPUPolicy::MLFQ && mlfq_boost > 0 && !events.empty())
+            k = min<long long>(k, (mlfq_boost - current_tick % mlfq_boost) % mlfq_boost);
+        return k;
+    }
+
+    void advance_idle(long long k) {
+        account_imbalance(k);
+        current_tick += k;
+    }
+
+    // pids en ejecución, en orden de CPU
+    vector<int> running_pids() const {
+        vector<int> out;
+        for (const CPU &c : cpus)
+            if (c.running_pid) out.push_back(c.running_pid.value());
+        return out;
+    }
+
+    void set_log_runs(bool on) { log_runs = on; }
+
     // ejecutar n ticks (ciclos)
     void run_ticks(int n, function<void(int)> on_run_pid = nullptr) {
         for (int i = 0; i < n; ++i) {
-            auto ran = tick();
-            if (ran && on_run_pid) on_run_pid(ran.value());
+            for (int pid : tick())
+                if (on_run_pid) on_run_pid(pid);
         }
     }
 
 
-    const unordered_map<int, PCB>& get_processes() const { return procs; }
+    // Mueve los procesos TERMINATED pendientes al archivo y libera sus slots
+    void reap() {
+        for (int pid : pending_reap) {
+            int slot = slot_of[pid];
+            const PCB &p = slab[slot];
+            const PCBInfo &pi = info[slot];
+            archive.push_back({pid, p.rafaga_restante, pi.rafaga_total, pi.npages, pi.llegada_tick,
+                               pi.inicio_tick, pi.fin_tick, pi.espera_acumulada, pi.page_faults});
+            info[slot] = PCBInfo(); // suelta la traza
+            slot_of[pid] = -(int)archive.size() - 1;
+            free_slots.push_back(slot);
+        }
+        pending_reap.clear();
+    }
 
+    int live_processes() const { return (int)slab.size() - (int)free_slots.size(); }
+    int archived_processes() const { return (int)archive.size(); }
+
+    // Acceso a un proceso por pid; nullptr si no existe
+    PCB *find_process(int pid) { return exists(pid) ? &pcb(pid) : nullptr; }
+    PCBInfo &process_info(int pid) { return info[slot_of[pid]]; }
+    const PCBInfo &process_info(int pid) const { return info[slot_of[pid]]; }
+
+    // Ticks de CPU recibidos: el total de ráfagas menos la actual y las que faltan tras sus E/S
+    int cpu_used(int pid) const {
+        const PCBInfo &pi = process_info(pid);
+        int left = pcb(pid).rafaga_restante;
+        for (size_t i = pi.io_next; i < pi.io.size(); ++i) left += pi.io[i].second;
+        return pi.rafaga_total - left;
+    }
 
-    unordered_map<int, PCB>& get_processes_mut() { return procs; }
+    // Espera total hasta ahora, incluyendo el periodo READY en curso
+    long long espera_total(int pid) const {
+        const PCB &p = pcb(pid);
+        return process_info(pid).espera_acumulada
+             + (p.estado == Estado::READY ? current_tick - p.ready_since : 0);
+    }
 
     // hace los procesos READY (usados en creation)
     void make_ready(int pid) {
-        if (procs.find(pid) == procs.end()) return;
-        auto &p = procs[pid];
-        if (p.estado == Estado::NEW) p.estado = Estado::READY;
-        // evita duplicados en ready_q
-        if (find(ready_q.begin(), ready_q.end(), pid) == ready_q.end())
-            ready_q.push_back(pid);
+        if (!exists(pid)) return;
+        auto &p = pcb(pid);
+        if (p.estado == Estado::NEW) {
+            p.estado = Estado::READY;
+            p.ready_since = current_tick;
+        }
+        // evita duplicados en la estructura de listos
+        if (p.estado == Estado::READY) enqueue_ready(pid);
     }
 
-    // Mostrar tabla de procesos
+    // Mostrar tabla de procesos; CPU solo para los RUNNING
     void ps() const {
-        cout << "PID\tESTADO\tRAFAGA\tNPAGES\tARR\tINI\tFIN\tESPERA\tPF\n";
-        for (auto &kv : procs) {
-            auto &p = kv.second;
+        cout << "PID\tESTADO\tRAFAGA\tNPAGES\tARR\tINI\tFIN\tESPERA\tPF\tCPU\n";
+        for (int pid = 1; pid < next_pid; ++pid) {
+            if (archived(pid)) {
+                auto &r = archive[-slot_of[pid] - 2];
+                cout << r.pid << "\t" << estado_to_str(Estado::TERMINATED) << "\t"
+                     << r.rafaga_restante << "\t" << r.npages << "\t"
+                     << r.llegada_tick << "\t" << r.inicio_tick << "\t"
+                     << r.fin_tick << "\t" << r.espera << "\t"
+                     << r.page_faults << "\t-\n";
+                continue;
+            }
+            if (!exists(pid)) continue;
+            auto &p = pcb(pid);
+            auto &pi = process_info(pid);
             cout << p.pid << "\t" << estado_to_str(p.estado) << "\t"
-                 << p.rafaga_restante << "\t" << p.npages << "\t"
-                 << p.llegada_tick << "\t" << p.inicio_tick << "\t"
-                 << p.fin_tick << "\t" << p.espera_acumulada << "\t"
-                 << p.page_faults << "\n";
+                 << p.rafaga_restante << "\t" << pi.npages << "\t"
+                 << pi.llegada_tick << "\t" << pi.inicio_tick << "\t"
+                 << pi.fin_tick << "\t" << espera_total(pid) << "\t"
+                 << pi.page_faults << "\t";
+            if (p.estado == Estado::RUNNING) cout << p.cpu << "\n"; else cout << "-\n";
+        }
+    }
+
+    // Utilización de cada CPU desde el último set_cpus
+    void cpu_stats() const {
+        long long span = current_tick - cpus_since;
+        cout << "CPU\tBUSY\tIDLE\tUTIL\tDISPATCHES\tRUNNING\tQUEUED\n";
+        for (int i = 0; i < (int)cpus.size(); ++i) {
+            const CPU &c = cpus[i];
+            cout << i << "\t" << c.busy_ticks << "\t" << span - c.busy_ticks << "\t"
+                 << fixed << setprecision(3) << (span ? (double)c.busy_ticks / span : 0.0) << defaultfloat << "\t"
+                 << c.dispatches << "\t";
+            if (c.running_pid) cout << c.running_pid.value(); else cout << "-";
+            cout << "\t" << c.rq.order.size << "\n";
+        }
+        cout << "Total utilization: " << fixed << setprecision(3) << utilization() << defaultfloat
+             << " over " << span << " ticks\n";
+    }
+
+    // Fracción de ticks-CPU ocupados desde el último set_cpus / set_balance
+    double utilization() const {
+        long long span = current_tick - cpus_since, busy = 0;
+        for (const CPU &c : cpus) busy += c.busy_ticks;
+        return span ? (double)busy / (span * (long long)cpus.size()) : 0.0;
+    }
+
+    // Cambia el número de dispositivos de E/S; solo sin E/S en curso ni procesos con E/S pendiente
+    // en un dispositivo que desaparecería. Reinicia su contabilidad.
+    bool set_devices(int n) {
+        if (!events.empty()) { cout << "I/O in progress, cannot change devices\n"; return false; }
+        // un proceso con E/S pendiente no puede quedar apuntando a un dispositivo que ya no existe
+        for (int pid = 1; pid < next_pid; ++pid) {
+            if (!exists(pid) || pcb(pid).estado == Estado::TERMINATED) continue;
+            const PCBInfo &pi = process_info(pid);
+            if (pi.io_next < (int)pi.io.size() && pi.device >= n) {
+                cout << "pid " << pid << " still uses device " << pi.device << ", cannot change devices\n";
+                return false;
+            }
+        }
+        devices.assign(max(1, n), Device());
+        swap = Device();
+        devices_since = current_tick;
+        cout << "Devices = " << devices.size() << "\n";
+        return true;
+    }
+
+    // Ocupación y colas de los dispositivos (y del área de intercambio si se usa) desde
+    // set_devices, junto a la utilización de CPU
+    void io_stats() const {
+        long long span = current_tick - devices_since;
+        int blocked = 0;
+        cout << "DEV\tBUSY\tUTIL\tDONE\tAVG_QWAIT\tSERVING\tQUEUED\n";
+        for (int i = 0; i <= (int)devices.size(); ++i) {
+            if (i == (int)devices.size() && swap_latency == 0 && swap.completed == 0 && swap.busy_pid < 0) break;
+            int id = i < (int)devices.size() ? i : SWAP_DEVICE;
+            const Device &d = device(id);
+            long long busy = d.busy_ticks + (d.busy_pid >= 0 ? max(0LL, current_tick - d.busy_since) : 0);
+            cout << device_name(id) << "\t" << busy << "\t" << fixed << setprecision(3) << (span ? (double)busy / span : 0.0) << "\t"
+                 << d.completed << "\t" << (d.completed ? (double)d.queue_wait / d.completed : 0.0) << defaultfloat << "\t";
+            if (d.busy_pid >= 0) cout << d.busy_pid; else cout << "-";
+            cout << "\t" << d.queue.size() << "\n";
+            for (const Device::Request &r : d.queue) blocked += exists(r.pid) && pcb(r.pid).estado == Estado::BLOCKED;
+            blocked += d.busy_pid >= 0 && exists(d.busy_pid) && pcb(d.busy_pid).estado == Estado::BLOCKED;
         }
+        cout << "Blocked processes: " << blocked << " CPU utilization: " << fixed << setprecision(3)
+             << utilization() << defaultfloat << " over " << current_tick - cpus_since << " ticks\n";
     }
 
-    int get_tick() const { return current_tick; }
+    // Latencia (ticks) del servicio de un fallo de página; 0 = el fallo no bloquea
+    void set_swap_latency(int t) {
+        swap_latency = max(0, t);
+        cout << "Swap latency = " << swap_latency << "\n";
+    }
+
+    int get_swap_latency() const { return swap_latency; }
+
+    // El proceso pid tuvo un fallo de página en el tick que acaba de pasar (se llama después de
+    // tick(), en orden de CPU): deja su CPU o la cola de listos y queda BLOCKED hasta que el área
+    // de intercambio cargue la página. Retorna false si los fallos no bloquean o ya no corre.
+    bool block_on_fault(int pid) {
+        if (swap_latency <= 0 || !exists(pid)) return false;
+        PCB &p = pcb(pid);
+        if (p.estado == Estado::RUNNING) {
+            vacate(cpus[p.cpu]);
+        } else if (p.estado == Estado::READY) {
+            // expropiado en ese mismo tick
+            dequeue_ready(pid);
+            leave_ready(p, current_tick);
+        } else {
+            return false; // terminó o se bloqueó por E/S en ese tick
+        }
+        p.estado = Estado::BLOCKED;
+        submit_io(SWAP_DEVICE, pid, swap_latency, current_tick);
+        cout << "[tick " << current_tick - 1 << "] BLOCKED pid=" << pid << " page_fault swap=" << swap_latency
+             << cpu_tag(p.cpu) << "\n";
+        return true;
+    }
+
+    // Fracción de tiempo ocupado promedio de los dispositivos desde set_devices
+    double device_utilization() const {
+        long long span = current_tick - devices_since, busy = 0;
+        for (const Device &d : devices)
+            busy += d.busy_ticks + (d.busy_pid >= 0 ? max(0LL, current_tick - d.busy_since) : 0);
+        return span ? (double)busy / (span * (long long)devices.size()) : 0.0;
+    }
+
+    // Fracción de tiempo ocupado del área de intercambio desde set_devices
+    double swap_utilization() const {
+        long long span = current_tick - devices_since;
+        long long busy = swap.busy_ticks + (swap.busy_pid >= 0 ? max(0LL, current_tick - swap.busy_since) : 0);
+        return span ? (double)busy / span : 0.0;
+    }
+
+    // Retorno (fin - llegada) promedio de los procesos terminados, cosechados o no
+    double avg_turnaround() const {
+        long long sum = 0, n = 0;
+        for (const ProcessRecord &r : archive) { sum += r.fin_tick - r.llegada_tick; n++; }
+        for (int pid : pending_reap) { sum += process_info(pid).fin_tick - process_info(pid).llegada_tick; n++; }
+        return n ? (double)sum / n : 0.0;
+    }
+
+    long long get_tick() const { return current_tick; }
+
+    long long get_dispatches() const { return dispatches; }
+    long long get_preemptions() const { return preemptions; }
+
+    // Índice de Jain sobre la CPU recibida por unidad de peso (o boleto) de los procesos vivos:
+    // 1 = reparto exactamente proporcional al peso, 1/n = un solo proceso se lleva todo
+    double weighted_fairness() const {
+        double sum = 0, sum_sq = 0; int n = 0;
+        for (int pid = 1; pid < next_pid; ++pid) {
+            if (!exists(pid) || pcb(pid).estado == Estado::TERMINATED) continue;
+            const PCB &p = pcb(pid);
+            double x = (double)cpu_used(pid) / share_weight(p);
+            sum += x; sum_sq += x * x; n++;
+        }
+        return sum_sq > 0 ? sum * sum / (n * sum_sq) : 1.0;
+    }
+
+    // Cambios de contexto y reparto de CPU por proceso vivo (porción pedida según peso o boletos vs obtenida)
+    void sched_stats() const {
+        cout << "Policy " << cpu_policy_to_str(policy) << " dispatches=" << dispatches
+             << " preemptions=" << preemptions << "\n";
+        long long total_cpu = 0, total_weight = 0;
+        for (int pid = 1; pid < next_pid; ++pid) {
+            if (!exists(pid) || pcb(pid).estado == Estado::TERMINATED) continue;
+            total_cpu += cpu_used(pid);
+            total_weight += share_weight(pcb(pid));
+        }
+        cout << "PID\tNICE\tWEIGHT\tTICKETS\tCPU\tVRUNTIME\tPASS\tWANT\tGOT\n";
+        for (int pid = 1; pid < next_pid; ++pid) {
+            if (!exists(pid) || pcb(pid).estado == Estado::TERMINATED) continue;
+            const PCB &p = pcb(pid);
+            const PCBInfo &pi = process_info(pid);
+            int cpu = cpu_used(pid);
+            cout << pid << "\t" << pi.nice << "\t" << p.weight << "\t" << p.tickets << "\t" << cpu << "\t"
+                 << p.vruntime << "\t" << p.pass << "\t"
+                 << fixed << setprecision(3) << (double)share_weight(p) / max(1LL, total_weight) << "\t"
+                 << (double)cpu / max(1LL, total_cpu) << defaultfloat << "\n";
+        }
+        cout << "Weighted fairness (Jain): " << fixed << setprecision(4) << weighted_fairness() << defaultfloat << "\n";
+    }
 };
 
 
@@ -388,6 +1939,17 @@ static string trim(const string &s) {
     return s.substr(a, b-a+1);
 }
 
+// Convierte s completo a int; false si tiene basura al final o no cabe en int
+static bool parse_int(const string &s, int &out) {
+    if (s.empty()) return false;
+    char *end;
+    errno = 0;
+    long v = strtol(s.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE || v < INT_MIN || v > INT_MAX) return false;
+    out = (int)v;
+    return true;
+}
+
 static vector<int> parse_trace(const string &s) {
     vector<int> out;
     string cur;
@@ -400,6 +1962,456 @@ static vector<int> parse_trace(const string &s) {
     return out;
 }
 
+// Lista de ráfagas de E/S "E:C,E:C,...": E ticks de E/S seguidos de una ráfaga de C ticks de CPU,
+// ambos >= 1. Retorna false (e informa el elemento) si alguno está mal formado.
+static bool parse_io_bursts(const string &s, vector<pair<int,int>> &out) {
+    out.clear();
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ',')) {
+        size_t colon = item.find(':');
+        int len, next_burst;
+        if (colon == string::npos || !parse_int(item.substr(0, colon), len) || !parse_int(item.substr(colon + 1), next_burst)
+            || len < 1 || next_burst < 1) {
+            cout << "Invalid io burst '" << item << "' (expected E:C with E,C >= 1)\n";
+            return false;
+        }
+        out.push_back({len, next_burst});
+    }
+    if (out.empty()) { cout << "Empty io burst list\n"; return false; }
+    return true;
+}
+
+static AccessLog access_log;
+
+// Curva aproximada en línea: con 'mrc_approx on <rate>' cada acceso alimenta al muestreador
+// directamente, sin registrar el flujo (memoria acotada por rate * páginas distintas)
+static unique_ptr<ShardsEngine> online_mrc;
+
+// Modo multi-política: el mismo flujo de accesos alimenta varios MemoryManager en paralelo
+// (uno por política, mismo número de frames) para comparar fallos sin re-ejecutar.
+struct LockstepMemory {
+    vector<MemoryManager> mems;
+
+    bool active() const { return !mems.empty(); }
+
+    void start(int nframes, const vector<ReplPolicy> &policies) {
+        mems.clear();
+        for (ReplPolicy pol : policies) mems.emplace_back(nframes, pol);
+    }
+
+    void advance_tick() { for (auto &m : mems) m.advance_tick(); }
+    void advance_ticks(long long k) { for (auto &m : mems) m.advance_ticks(k); }
+
+    void access(int pid, int page, int next_use) {
+        for (auto &m : mems) m.access_page(pid, page, next_use);
+    }
+
+    void release_process(int pid) { for (auto &m : mems) m.release_process(pid); }
+
+    void report() const {
+        cout << "POLICY\tFRAMES\tFAULTS\tREPLACEMENTS\n";
+        for (auto &m : mems)
+            cout << repl_policy_to_str(m.get_policy()) << "\t" << m.num_frames() << "\t"
+                 << m.get_total_page_faults() << "\t" << m.get_total_replacements() << "\n";
+    }
+};
+
+static LockstepMemory lockstep;
+
+static void release_memory(MemoryManager &mem, int pid) {
+    mem.release_process(pid);
+    lockstep.release_process(pid);
+}
+
+static bool log_hits = true; // el modo por eventos omite las líneas HIT
+
+// Realiza el acceso a memoria del proceso que ejecutó en este tick:
+// elige página de la traza o aleatoriamente y cuenta el fallo de página si ocurre.
+// Si el proceso terminó en este tick, sus frames se liberan después del acceso.
+// Retorna true si el acceso fue un acierto
+static bool access_memory(Scheduler &sched, MemoryManager &mem, int pid) {
+    PCB *pp = sched.find_process(pid);
+    if (!pp) return false;
+    PCBInfo &p = sched.process_info(pid);
+    int page = 0;
+    int next_use = -1;
+    if (!p.trace.empty()) {
+        if (p.trace_pos >= (int)p.trace.size()) p.trace_pos = 0;
+        next_use = p.trace_next[p.trace_pos];
+        page = p.trace[p.trace_pos++];
+        if (page < 0 || page >= p.npages) page = page % p.npages;
+    } else {
+        // pagina random
+        std::uniform_int_distribution<int> dist(0, max(0,p.npages-1));
+        page = dist(rng);
+    }
+    if (access_log.enabled) access_log.keys.push_back(MemoryManager::page_key(pid, page));
+    if (online_mrc) online_mrc->access(MemoryManager::page_key(pid, page));
+    auto res = mem.access_page(pid, page, next_use);
+    lockstep.access(pid, page, next_use);
+    if (!res.first) {
+        // fallo de pagina
+        p.page_faults++;
+        cout << "[tick " << sched.get_tick()-1 << "] PAGE_FAULT pid=" << pid << " page=" << page << " loaded in frame=" << res.second << "\n";
+        // con latencia de intercambio el proceso espera la carga de la página fuera de la CPU
+        sched.block_on_fault(pid);
+    } else if (log_hits) {
+        cout << "[tick " << sched.get_tick()-1 << "] HIT pid=" << pid << " page=" << page << "\n";
+    }
+    if (pp->estado == Estado::TERMINATED) release_memory(mem, pid);
+    return res.first;
+}
+
+// Un tick completo: avanza el reloj de memoria, el planificador y los accesos de los procesos
+// que corrieron, en orden de CPU. Retorna true si hubo accesos y todos fueron aciertos
+static bool simulate_tick(Scheduler &sched, MemoryManager &mem) {
+    mem.advance_tick();
+    lockstep.advance_tick();
+    bool all_hits = true, any = false;
+    for (int pid : sched.tick()) {
+        any = true;
+        if (!access_memory(sched, mem, pid)) all_hits = false;
+    }
+    return any && all_hits;
+}
+
+// Ejecuta n ticks saltando directamente al próximo evento cuando no pasa nada observable:
+//  - CPU ociosa y sin procesos listos: el reloj avanza de un salto hasta el próximo fin de E/S.
+//  - Procesos con traza entre eventos del planificador (fin de ráfaga o de quantum): se
+//    simula tick a tick hasta que un ciclo completo de las trazas son aciertos (el periodo
+//    es el mcm de sus largos si hay varias CPUs); desde ahí el estado es periódico y solo se
+//    reproduce el último periodo del tramo, que fija los mismos tiempos de acceso, orden
+//    LRU, bits CLOCK y próximos usos OPT.
+// Los procesos sin traza consumen un número aleatorio por tick, así que se simulan tick a
+// tick (sin imprimir); lo mismo si se registra el flujo, hay comparación de políticas o se
+// muestrea la curva en línea.
+// Con latencia de intercambio, tras un tick con fallos el tramo se recalcula (el fallo pudo
+// bloquear al proceso y liberar su CPU).
+// El estado final de PCBs y memoria es el mismo que con run tick a tick.
+static void run_events(Scheduler &sched, MemoryManager &mem, int n) {
+    int left = n;
+    while (left > 0) {
+        if (sched.idle()) {
+            // sin nada que ejecutar, el reloj salta hasta el próximo fin de E/S
+            int k = (int)min<long long>(left, sched.idle_quiet_ticks());
+            if (k == 0) { simulate_tick(sched, mem); left--; continue; }
+            sched.advance_idle(k);
+            mem.advance_ticks(k);
+            lockstep.advance_ticks(k);
+            left -= k;
+            continue;
+        }
+        int k = (int)min<long long>(left, sched.quiet_ticks());
+        if (k == 0) { simulate_tick(sched, mem); left--; continue; }
+        left -= k;
+        vector<PCBInfo*> running;
+        long long len = 1; // periodo conjunto de las trazas en ejecución
+        bool can_skip = !access_log.enabled && !lockstep.active() && !online_mrc;
+        for (int pid : sched.running_pids()) {
+            PCBInfo &p = sched.process_info(pid);
+            running.push_back(&p);
+            if (p.trace.empty()) { can_skip = false; break; }
+            len = lcm(len, (long long)p.trace.size());
+            if (len > k) { can_skip = false; break; }
+        }
+        int streak = 0; // ticks consecutivos en que todos los accesos fueron aciertos
+        while (k > 0) {
+            if (can_skip && streak >= len && k > len) {
+                int jump = k - (int)len;
+                sched.advance_running(jump);
+                mem.advance_ticks(jump);
+                for (PCBInfo *p : running) p->trace_pos = (p->trace_pos + jump) % (int)p->trace.size();
+                k = (int)len;
+                can_skip = false;
+                continue;
+            }
+            streak = simulate_tick(sched, mem) ? streak + 1 : 0;
+            k--;
+            // un fallo pudo bloquear un proceso y liberar su CPU: hay que recalcular el tramo
+            if (streak == 0 && sched.get_swap_latency() > 0) { left += k; break; }
+        }
+    }
+}
+
+// Benchmarks (comandos bench_*)
+
+// Silencia cout mientras está vivo (los benchmarks no deben medir la impresión del log)
+struct QuietOutput {
+    streambuf *saved;
+    QuietOutput() : saved(cout.rdbuf(nullptr)) {}
+    ~QuietOutput() { cout.rdbuf(saved); cout.clear(); }
+};
+
+// Mide el costo de despacho según el número de procesos, para SJF y RR (quantum 2):
+// crea n procesos con ráfagas pseudoaleatorias y ejecuta hasta que todos terminan.
+// Los terminados siguen en la tabla como historia.
+static void bench_scheduler(const vector<int> &proc_counts) {
+    cout << "PROCS\tPOLICY\tTICKS\tDISPATCHES\tNS/DISPATCH\tTICKS/SEC\n";
+    for (int n : proc_counts) {
+        for (CPUPolicy pol : {CPUPolicy::SJF_NONPREEMPTIVE, CPUPolicy::RR}) {
+            Scheduler s(pol, pol == CPUPolicy::RR ? 2 : 0);
+            std::mt19937 gen(777);
+            std::uniform_int_distribution<int> dburst(1, 4);
+            long long ticks = 0, dispatches = 0;
+            double secs;
+            {
+                QuietOutput quiet;
+                long long total_burst = 0;
+                for (int i = 0; i < n; ++i) {
+                    int b = dburst(gen);
+                    total_burst += b;
+                    dispatches += pol == CPUPolicy::RR ? (b + 1) / 2 : 1;
+                    s.create_process(b, 1);
+                }
+                auto t0 = chrono::steady_clock::now();
+                for (; ticks < total_burst; ++ticks) s.tick();
+                secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+            }
+            cout << n << "\t" << (pol == CPUPolicy::RR ? "RR" : "SJF") << "\t" << ticks << "\t" << dispatches << "\t"
+                 << (long long)(secs * 1e9 / max(1LL, dispatches)) << "\t"
+                 << (long long)(ticks / max(secs, 1e-9)) << "\n";
+        }
+    }
+}
+
+// Compara RR, CFS, stride y lotería con la misma carga: n procesos que nunca terminan, con
+// nice pseudoaleatorio en -10..10 y tantos boletos como el peso de ese nice, durante 'ticks'
+// ticks. q es el quantum (granularidad mínima en CFS). Reporta cambios de contexto y el
+// índice de Jain ponderado.
+static void bench_fairness(int nprocs, int ticks, int q) {
+    cout << "POLICY\tDISPATCHES\tPREEMPTIONS\tSWITCH/KTICK\tFAIRNESS\tTICKS/SEC\n";
+    for (CPUPolicy pol : {CPUPolicy::RR, CPUPolicy::CFS, CPUPolicy::STRIDE, CPUPolicy::LOTTERY}) {
+        Scheduler s;
+        std::mt19937 gen(777);
+        std::uniform_int_distribution<int> dnice(-10, 10);
+        double secs;
+        {
+            QuietOutput quiet;
+            s.set_policy(pol, q);
+            for (int i = 0; i < nprocs; ++i) {
+                int nice = dnice(gen);
+                s.create_process(ticks + 1, 1, {}, nice, nice_to_weight[nice + 20]);
+            }
+            s.set_log_runs(false);
+            auto t0 = chrono::steady_clock::now();
+            for (int t = 0; t < ticks; ++t) s.tick();
+            secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        }
+        cout << cpu_policy_to_str(pol) << "\t" << s.get_dispatches() << "\t" << s.get_preemptions() << "\t"
+             << fixed << setprecision(1) << 1000.0 * s.get_dispatches() / max(1, ticks) << "\t"
+             << setprecision(4) << s.weighted_fairness() << defaultfloat << "\t"
+             << (long long)(ticks / max(secs, 1e-9)) << "\n";
+    }
+}
+
+// Compara el balanceo entre CPUs con la misma carga: n procesos creados en el tick 0 con
+// ráfagas de largo exponencial (media 50), repartidos por cantidad pero no por trabajo.
+// Corre hasta que todos terminan con cada modo: sin balanceo, robo de trabajo y rebalanceo
+// periódico, ambos con el mismo costo de migración.
+static void bench_balance(int ncpus, int nprocs, int cost, int period) {
+    cout << "MODE\tMAKESPAN\tUTIL\tSTEALS\tMIGRATIONS\tAVG_IMBALANCE\tTICKS/SEC\n";
+    for (BalanceMode mode : {BalanceMode::NONE, BalanceMode::STEAL, BalanceMode::PERIODIC}) {
+        Scheduler s;
+        std::mt19937 gen(777);
+        std::exponential_distribution<double> dburst(1.0 / 50);
+        double secs;
+        {
+            QuietOutput quiet;
+            s.set_cpus(ncpus);
+            s.set_balance(mode, mode == BalanceMode::PERIODIC ? period : 1, cost);
+            for (int i = 0; i < nprocs; ++i) s.create_process(1 + (int)dburst(gen), 1);
+            s.set_log_runs(false);
+            auto t0 = chrono::steady_clock::now();
+            while (!s.idle()) s.tick();
+            secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        }
+        cout << balance_mode_to_str(mode) << "\t" << s.get_tick() << "\t"
+             << fixed << setprecision(3) << s.utilization() << defaultfloat << "\t"
+             << s.get_steals() << "\t" << s.get_migrations() << "\t"
+             << fixed << setprecision(3) << s.avg_imbalance() << defaultfloat << "\t"
+             << (long long)(s.get_tick() / max(secs, 1e-9)) << "\n";
+    }
+}
+
+// Utilización de CPU bajo mezclas con una fracción creciente de procesos limitados por E/S:
+// los de CPU tienen una ráfaga de 100 ticks; los de E/S, 10 ráfagas de 2 ticks de CPU separadas
+// por 9 esperas de 10 ticks de E/S, repartidos entre ndevices dispositivos. RR quantum 2 hasta que todos terminan.
+static void bench_io(int ncpus, int nprocs, int ndevices) {
+    cout << "IO_BOUND\tMAKESPAN\tCPU_UTIL\tDEV_UTIL\tAVG_TURNAROUND\n";
+    for (int pct : {0, 25, 50, 75, 100}) {
+        Scheduler s;
+        {
+            QuietOutput quiet;
+            s.set_cpus(ncpus);
+            s.set_devices(ndevices);
+            for (int i = 0; i < nprocs; ++i) {
+                // reparte los pct% limitados por E/S de forma pareja entre los creados
+                if ((i + 1) * pct / 100 > i * pct / 100)
+                    s.create_process(2, 1, {}, 0, 100, vector<pair<int,int>>(9, {10, 2}), i % ndevices);
+                else
+                    s.create_process(100, 1);
+            }
+            s.set_log_runs(false);
+            while (!s.idle() || s.io_pending()) s.tick();
+        }
+        cout << pct << "%\t" << s.get_tick() << "\t" << fixed << setprecision(3) << s.utilization() << "\t"
+             << s.device_utilization() << "\t" << setprecision(1) << s.avg_turnaround() << defaultfloat << "\n";
+    }
+}
+
+// Colapso por hiperpaginación: nprocs procesos con RR (quantum 2) recorren en ciclo una traza
+// de 'pages' páginas distintas con LRU global, y cada fallo los bloquea 'latency' ticks. Para
+// cada número de frames corre hasta que todos terminan y reporta fallos, uso de CPU y del
+// intercambio, makespan y retorno medio. Por debajo del conjunto de trabajo total
+// (nprocs * pages) casi todo acceso falla y la CPU queda ociosa esperando al intercambio.
+static void bench_thrash(int nprocs, int pages, int burst, int latency, const vector<int> &frame_counts) {
+    cout << "Working set: " << nprocs * pages << " pages, swap latency " << latency << "\n";
+    cout << "FRAMES\tFAULTS\tCPU_UTIL\tSWAP_UTIL\tMAKESPAN\tAVG_TURNAROUND\n";
+    // la corrida no debe alimentar el registro de accesos, la comparación de políticas ni la curva en línea
+    bool saved_log = access_log.enabled;
+    vector<MemoryManager> saved_mems;
+    swap(saved_mems, lockstep.mems);
+    unique_ptr<ShardsEngine> saved_mrc = move(online_mrc);
+    access_log.enabled = false;
+    // la mitad de los accesos va a la cuarta parte de las páginas (localidad), el resto recorre todas
+    vector<int> trace;
+    for (int j = 0; j < pages; ++j) {
+        trace.push_back(j % max(1, pages / 4));
+        trace.push_back(j);
+    }
+    for (int nf : frame_counts) {
+        Scheduler s;
+        MemoryManager m(nf, ReplPolicy::LRU);
+        {
+            QuietOutput quiet;
+            s.set_swap_latency(latency);
+            for (int i = 0; i < nprocs; ++i) s.create_process(burst, pages, trace);
+            s.set_log_runs(false);
+            while (!s.idle() || s.io_pending()) simulate_tick(s, m);
+        }
+        cout << nf << "\t" << m.get_total_page_faults() << "\t" << fixed << setprecision(3) << s.utilization() << "\t"
+             << s.swap_utilization() << "\t" << s.get_tick() << "\t" << setprecision(1) << s.avg_turnaround()
+             << defaultfloat << "\n";
+    }
+    access_log.enabled = saved_log;
+    swap(saved_mems, lockstep.mems);
+    online_mrc = move(saved_mrc);
+}
+
+// Ticks/seg simulados según los hilos de host (1, 2, 4, ... hasta ncpus) con la misma carga:
+// ncpus CPUs con RR, nprocs procesos de ráfaga pseudoaleatoria y lotería de boletos.
+// DIGEST resume qué pid corrió en cada CPU en cada tick; debe ser igual para todos los hilos.
+static void bench_parallel(int ncpus, int nprocs, int ticks) {
+    cout << "Host hardware threads: " << thread::hardware_concurrency() << "\n";
+    cout << "THREADS\tTICKS\tTICKS/SEC\tSPEEDUP\tDIGEST\tSAME\n";
+    double base = 0;
+    unsigned long long ref = 0;
+    for (int t = 1; ; t *= 2) {
+        t = min(t, ncpus);
+        Scheduler s;
+        std::mt19937 gen(777);
+        std::uniform_int_distribution<int> dburst(1, 2000), dtickets(1, 500);
+        unsigned long long digest = 1469598103934665603ULL; // FNV-1a
+        double secs;
+        {
+            QuietOutput quiet;
+            s.set_cpus(ncpus);
+            s.set_policy(CPUPolicy::LOTTERY, 2);
+            s.set_host_threads(t);
+            for (int i = 0; i < nprocs; ++i) s.create_process(dburst(gen), 1, {}, 0, dtickets(gen));
+            s.set_log_runs(false);
+            auto t0 = chrono::steady_clock::now();
+            for (int k = 0; k < ticks; ++k)
+                for (int pid : s.tick()) digest = (digest ^ (unsigned long long)pid) * 1099511628211ULL;
+            secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        }
+        double rate = ticks / max(secs, 1e-9);
+        if (t == 1) { base = rate; ref = digest; }
+        cout << s.get_host_threads() << "\t" << ticks << "\t" << (long long)rate << "\t"
+             << fixed << setprecision(2) << rate / base << defaultfloat << "\t"
+             << hex << digest << dec << "\t" << (digest == ref ? "yes" : "NO") << "\n";
+        if (t == ncpus) break;
+    }
+}
+
+// Mide accesos/seg de MemoryManager para varios tamaños de memoria.
+// La carga es determinista: 16 procesos con un conjunto de trabajo 2x el número de frames.
+static void bench_memory(long long accesses, const vector<int> &frame_counts) {
+    cout << "FRAMES\tPOLICY\tACCESSES\tFAULTS\tACC/SEC\n";
+    for (int nf : frame_counts) {
+        for (ReplPolicy pol : {ReplPolicy::FIFO, ReplPolicy::LRU, ReplPolicy::CLOCK}) {
+            MemoryManager m(nf, pol);
+            std::mt19937 gen(12345);
+            const int nprocs = 16;
+            int pages_per_proc = max(1, (2 * nf) / nprocs);
+            std::uniform_int_distribution<int> dpid(1, nprocs), dpage(0, pages_per_proc - 1);
+            auto t0 = chrono::steady_clock::now();
+            for (long long i = 0; i < accesses; ++i) {
+                m.advance_tick();
+                m.access_page(dpid(gen), dpage(gen));
+            }
+            double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+            cout << nf << "\t" << repl_policy_to_str(pol) << "\t"
+                 << accesses << "\t" << m.get_total_page_faults() << "\t"
+                 << (long long)(accesses / max(secs, 1e-9)) << "\n";
+        }
+    }
+}
+
+// Imprime la curva de fallos LRU para 1..max_frames frames a partir del flujo registrado
+static void print_mrc(const vector<long long> &stream, int max_frames, int step) {
+    auto engine = StackDistanceEngine::replay(stream);
+    if (max_frames <= 0) max_frames = (int)engine.footprint();
+    step = max(1, step);
+    auto curve = engine.faults_curve(max_frames);
+    cout << "Accesses: " << engine.accesses() << " distinct pages: " << engine.footprint() << "\n";
+    cout << "FRAMES\tFAULTS\tMISS_RATIO\n";
+    for (int c = 1; c <= max_frames; c += step) {
+        long long f = curve[c - 1];
+        cout << c << "\t" << f << "\t" << fixed << setprecision(4)
+             << (engine.accesses() ? (double)f / engine.accesses() : 0.0) << defaultfloat << "\n";
+    }
+}
+
+// Compara la curva aproximada (muestreo) con la exacta sobre el mismo flujo registrado
+static void print_mrc_approx(const vector<long long> &stream, double rate, int max_frames, int step) {
+    ShardsEngine approx(rate);
+    for (long long k : stream) approx.access(k);
+    auto exact = StackDistanceEngine::replay(stream);
+    if (max_frames <= 0) max_frames = (int)exact.footprint();
+    step = max(1, step);
+    auto ca = approx.faults_curve(max_frames);
+    auto ce = exact.faults_curve(max_frames);
+    double n = (double)max<long long>(1, exact.accesses());
+    cout << "Accesses: " << exact.accesses() << " distinct pages: " << exact.footprint()
+         << " sampled pages: " << approx.tracked_pages() << " (rate " << rate << ")\n";
+    cout << "FRAMES\tEXACT_MR\tAPPROX_MR\tABS_ERR\n";
+    double sum_err = 0, max_err = 0; int points = 0;
+    for (int c = 1; c <= max_frames; ++c) {
+        double me = ce[c - 1] / n, ma = ca[c - 1] / n, err = fabs(ma - me);
+        sum_err += err; max_err = max(max_err, err); points++;
+        if ((c - 1) % step == 0)
+            cout << c << "\t" << fixed << setprecision(4) << me << "\t" << ma << "\t" << err << defaultfloat << "\n";
+    }
+    cout << "Mean abs error: " << fixed << setprecision(4) << (points ? sum_err / points : 0.0)
+         << " max abs error: " << max_err << defaultfloat << "\n";
+}
+
+// Curva aproximada del muestreador en línea; sin flujo registrado no hay curva exacta con qué
+// compararla. Por defecto llega hasta el número estimado de páginas distintas.
+static void print_mrc_online(const ShardsEngine &approx, int max_frames, int step) {
+    if (max_frames <= 0) max_frames = (int)max(1LL, approx.estimated_footprint());
+    step = max(1, step);
+    auto ca = approx.faults_curve(max_frames);
+    double n = (double)max<long long>(1, approx.accesses());
+    cout << "Accesses: " << approx.accesses() << " sampled pages: " << approx.tracked_pages()
+         << " (rate " << approx.sampling_rate() << ") estimated distinct pages: " << approx.estimated_footprint() << "\n";
+    cout << "FRAMES\tAPPROX_FAULTS\tAPPROX_MR\n";
+    for (int c = 1; c <= max_frames; c += step)
+        cout << c << "\t" << ca[c - 1] << "\t" << fixed << setprecision(4) << ca[c - 1] / n << defaultfloat << "\n";
+}
+
 int main() {
     cout << "=== OS Simulator (SJF non-preemptive + LRU) ===\n";
     cout << "Nota: scheduler default = RR quantum=2, page policy default = FIFO\n";
@@ -407,6 +2419,7 @@ int main() {
 
     Scheduler sched(CPUPolicy::RR, 2);
     MemoryManager mem(8, ReplPolicy::FIFO); 
+    bool event_mode = false; // run salta entre eventos en lugar de simular tick a tick
 
     string line;
     while (true) {
@@ -420,16 +2433,47 @@ int main() {
 
         if (cmd == "help") {
             cout << "Comandos:\n"
-                 << "  new <burst> [npages] [trace_comma_sep]   -> crear proceso\n"
-                 << "     e.g. new 10 4 0,1,2,1  (burst=10,npages=4,trace)\n"
+                 << "  new <burst> [npages] [trace_comma_sep] [nice=N] [tickets=N] -> crear proceso\n"
+                 << "     e.g. new 10 4 0,1,2,1 nice=5  (burst=10,npages=4,trace,nice)\n"
+                 << "     io=E:C,E:C.. dev=N -> tras cada ráfaga de CPU, E ticks de E/S en el dispositivo N y otra ráfaga de C\n"
+                 << "     e.g. new 3 4 io=10:3,10:2  (CPU 3, E/S 10, CPU 3, E/S 10, CPU 2)\n"
                  << "  ps                                       -> listar procesos\n"
                  << "  tick                                     -> avanzar 1 tick\n"
                  << "  run N                                    -> ejecutar N ticks\n"
+                 << "  set_runmode TICK|EVENT                   -> run tick a tick o saltando al próximo evento\n"
+                 << "  seed N                                   -> fijar la semilla de las páginas aleatorias\n"
                  << "  kill PID                                 -> matar proceso\n"
                  << "  set_sched RR <quantum>                   -> Round-Robin\n"
-                 << "  set_sched SJF                            -> SJF no-expropiativo\n                 "
-                 << "  set_pagemode FIFO|LRU <nframes>          -> set replacement and optionally resize frames\n"
+                 << "  set_sched SJF                            -> SJF no-expropiativo\n"
+                 << "  set_sched SRTF                           -> menor tiempo restante primero (expropiativo)\n"
+                 << "  set_sched MLFQ <niveles> <boost> [q0 q1..] -> colas multinivel con retroalimentación\n"
+                 << "  set_sched CFS [gran]                     -> menor vruntime primero, granularidad mínima gran\n"
+                 << "  set_sched STRIDE|LOTTERY [quantum]       -> reparto proporcional a los boletos\n"
+                 << "  schedstat                                -> cambios de contexto y CPU por proceso vs su peso\n"
+                 << "  set_cpus N                               -> simular N CPUs, cada una con su cola de listos\n"
+                 << "  cpustat                                  -> utilización por CPU\n"
+                 << "  set_balance NONE|STEAL [umbral] [costo]|PERIODIC [periodo] [costo] -> balanceo entre CPUs\n"
+                 << "  balstat                                  -> robos, migraciones y desbalance en el tiempo\n"
+                 << "  set_devices N                            -> N dispositivos de E/S (cada uno atiende una petición a la vez)\n"
+                 << "  set_swap N                               -> un fallo de página bloquea al proceso N ticks (0 = sin costo)\n"
+                 << "  bench_thrash [nprocs] [pages] [burst] [latencia] -> fallos, uso de CPU y retorno según los frames\n"
+                 << "  iostat                                   -> ocupación y cola de cada dispositivo, bloqueados y uso de CPU\n"
+                 << "  bench_io [ncpus] [nprocs] [ndevices]     -> utilización de CPU según la fracción de procesos de E/S\n"
+                 << "  set_threads N                            -> avanzar las CPUs simuladas con N hilos del host\n"
+                 << "  bench_parallel [ncpus] [nprocs] [ticks]  -> ticks/seg según hilos del host (salida idéntica)\n"
+                 << "  bench_balance [ncpus] [nprocs] [costo] [periodo] -> sin balanceo vs robo vs rebalanceo periódico\n"
+                 << "  set_pagemode FIFO|LRU|CLOCK|OPT <nframes> -> set replacement and optionally resize frames\n"
                  << "  memstat                                  -> mostrar frames y stats\n"
+                 << "  compare_policies <nframes> [pols...]|off -> alimentar varias políticas con el mismo flujo\n"
+                 << "  memcmp                                   -> fallos y reemplazos por política lado a lado\n"
+                 << "  record on|off|clear                      -> registrar el flujo de accesos a memoria\n"
+                 << "  mrc [max_frames] [step]                  -> curva de fallos LRU para 1..max_frames en una pasada\n"
+                 << "  mrc_approx <rate> [max_frames] [step]    -> curva aproximada por muestreo y su error vs la exacta\n"
+                 << "  mrc_approx on <rate>|off                 -> muestrear en línea cada acceso, sin registrar el flujo\n"
+                 << "  mrc_approx show [max_frames] [step]      -> curva aproximada del muestreo en línea\n"
+                 << "  bench_mem <accesses> [nframes...]        -> benchmark de accesos/seg por tamaño de memoria\n"
+                 << "  bench_sched [nprocs...]                  -> benchmark del costo de despacho SJF y RR\n"
+                 << "  bench_fair [nprocs] [ticks] [q]          -> cambios de contexto y equidad de RR, CFS, stride y lotería\n"
                  << "  help                                     -> mostrar ayuda\n"
                  << "  exit                                     -> salir\n";
         }
@@ -439,36 +2483,46 @@ int main() {
         }
         else if (cmd == "new") {
             int burst; if (!(ss >> burst)) { cout << "new requires burst\n"; continue; }
-            int np = 4;
-            if (ss >> np) {
-
-
-                // Se consumió np; el siguiente token podría ser una cadena de seguimiento (resto de la línea)
-                string rest; getline(ss, rest);
-                rest = trim(rest);
-                if (!rest.empty()) {
-                // Analizar enteros separados por comas
-                    auto tr = parse_trace(rest);
-                    int pid = sched.create_process(burst, np, tr);
-                    sched.make_ready(pid);
+            // Tokens clave=valor son opciones; del resto, el primero es npages y los demás la traza
+            int np = 4, nice = 0, tickets = 100, device = 0;
+            vector<pair<int,int>> io;
+            string tok, trace_str;
+            bool have_np = false, bad = false;
+            while (ss >> tok) {
+                size_t eq = tok.find('=');
+                if (eq != string::npos) {
+                    string key = tok.substr(0, eq), val = tok.substr(eq + 1);
+                    if (key == "nice") {
+                        if (!parse_int(val, nice)) { cout << "Invalid nice value " << val << "\n"; bad = true; }
+                    } else if (key == "tickets") {
+                        if (!parse_int(val, tickets)) { cout << "Invalid tickets value " << val << "\n"; bad = true; }
+                    } else if (key == "io") {
+                        if (!parse_io_bursts(val, io)) bad = true;
+                    } else if (key == "dev") {
+                        if (!parse_int(val, device) || device < 0 || device >= sched.num_devices()) {
+                            cout << "Invalid device " << val << " (devices 0.." << sched.num_devices() - 1 << ", see set_devices)\n";
+                            bad = true;
+                        }
+                    } else { cout << "Unknown option " << key << "\n"; bad = true; }
+                } else if (!have_np) {
+                    if (!parse_int(tok, np) || np < 1) { cout << "Invalid npages " << tok << "\n"; bad = true; }
+                    have_np = true;
                 } else {
-                    int pid = sched.create_process(burst, np, {});
-                    sched.make_ready(pid);
+                    trace_str += tok + " ";
                 }
-            } else {
-
-
-            // solo se dio una ráfaga
-                int pid = sched.create_process(burst, 4, {});
-                sched.make_ready(pid);
             }
+            vector<int> trace;
+            try { trace = parse_trace(trace_str); } catch (...) { cout << "Invalid trace " << trim(trace_str) << "\n"; bad = true; }
+            if (bad) { cout << "Usage: new <burst> [npages] [trace_comma_sep] [nice=N] [tickets=N] [io=E:C,..] [dev=N]\n"; continue; }
+            int pid = sched.create_process(burst, np, trace, nice, tickets, io, device);
+            sched.make_ready(pid);
         }
         else if (cmd == "ps") {
             sched.ps();
         }
         else if (cmd == "kill") {
             int pid; if (!(ss >> pid)) { cout << "kill requires pid\n"; continue; }
-            sched.kill_process(pid);
+            if (sched.kill_process(pid)) release_memory(mem, pid);
         }
         else if (cmd == "set_sched") {
             string arg; ss >> arg;
@@ -477,93 +2531,218 @@ int main() {
                 sched.set_policy(CPUPolicy::RR, q);
             } else if (arg == "SJF") {
                 sched.set_policy(CPUPolicy::SJF_NONPREEMPTIVE, 0);
+            } else if (arg == "SRTF") {
+                sched.set_policy(CPUPolicy::SRTF, 0);
+            } else if (arg == "MLFQ") {
+                // MLFQ <niveles> <boost> [q0 q1 ...]; los quanta faltantes duplican al anterior
+                int levels = 3, boost = 50; ss >> levels >> boost;
+                levels = min(max(levels, 1), 64);
+                vector<int> quanta; int q;
+                while ((int)quanta.size() < levels && ss >> q) quanta.push_back(q);
+                if (quanta.empty()) quanta.push_back(2);
+                // la duplicación se satura en INT_MAX (con muchos niveles desbordaría int)
+                while ((int)quanta.size() < levels) quanta.push_back((int)min<long long>(quanta.back() * 2LL, INT_MAX));
+                sched.configure_mlfq(quanta, boost);
+                sched.set_policy(CPUPolicy::MLFQ, quanta[0]);
+            } else if (arg == "CFS") {
+                int gran = 2; ss >> gran;
+                sched.set_policy(CPUPolicy::CFS, gran);
+            } else if (arg == "STRIDE" || arg == "LOTTERY") {
+                int q = 2; ss >> q;
+                sched.set_policy(arg == "STRIDE" ? CPUPolicy::STRIDE : CPUPolicy::LOTTERY, max(1, q));
             } else {
-                cout << "Unknown scheduler. Use RR or SJF\n";
+                cout << "Unknown scheduler. Use RR, SJF, SRTF, MLFQ, CFS, STRIDE or LOTTERY\n";
             }
         }
         else if (cmd == "set_pagemode") {
             string arg; ss >> arg;
-            if (arg == "FIFO") {
-                int newframes = -1; if (ss >> newframes) {
-                    mem = MemoryManager(newframes, ReplPolicy::FIFO);
-                } else mem.set_policy(ReplPolicy::FIFO);
-                cout << "Page replacement = FIFO\n";
-            } else if (arg == "LRU") {
-                int newframes = -1; if (ss >> newframes) {
-                    mem = MemoryManager(newframes, ReplPolicy::LRU);
-                } else mem.set_policy(ReplPolicy::LRU);
-                cout << "Page replacement = LRU\n";
-            } else {
-                cout << "Usage: set_pagemode FIFO|LRU [nframes]\n";
-            }
+            ReplPolicy pol;
+            if (!parse_repl_policy(arg, pol)) { cout << "Usage: set_pagemode FIFO|LRU|CLOCK|OPT [nframes]\n"; continue; }
+            int newframes = -1; if (ss >> newframes) {
+                mem = MemoryManager(newframes, pol);
+            } else mem.set_policy(pol);
+            cout << "Page replacement = " << repl_policy_to_str(pol) << "\n";
         }
         else if (cmd == "memstat") {
             cout << "Memory stats at tick " << sched.get_tick() << "\n";
             cout << "Total page faults: " << mem.get_total_page_faults()
-                 << " total replacements: " << mem.get_total_replacements() << "\n";
+                 << " total replacements: " << mem.get_total_replacements()
+                 << " free frames: " << mem.get_free_frames() << "\n";
             mem.dump_frames();
         }
-        else if (cmd == "tick") {
-            // avanzar la memoria del tick primero
-            mem.advance_tick();
-            // El tick del planificador devuelve el pid que ejecutó este tick
-            auto ran = sched.tick();
-            if (ran) {
-                int pid = ran.value();
-        // Realizar acceso a memoria para el pid: elegir página de la traza o aleatoriamente.
-                auto &procs = sched.get_processes_mut();
-                if (procs.find(pid) != procs.end()) {
-                    PCB &p = procs[pid];
-                    int page = 0;
-                    if (!p.trace.empty()) {
-                        if (p.trace_pos >= (int)p.trace.size()) p.trace_pos = 0;
-                        page = p.trace[p.trace_pos++];
-                        if (page < 0 || page >= p.npages) page = page % p.npages;
-                    } else {
-                        // pagina random
-                        std::uniform_int_distribution<int> dist(0, max(0,p.npages-1));
-                        page = dist(rng);
-                    }
-                    auto res = mem.access_page(pid, page);
-                    if (!res.first) {
-                        // fallo de pagina
-                        p.page_faults++;
-                        cout << "[tick " << sched.get_tick()-1 << "] PAGE_FAULT pid=" << pid << " page=" << page << " loaded in frame=" << res.second << "\n";
-                    } else {
-                        cout << "[tick " << sched.get_tick()-1 << "] HIT pid=" << pid << " page=" << page << "\n";
-                    }
-                }
+        else if (cmd == "record") {
+            string arg; ss >> arg;
+            if (arg == "on") access_log.enabled = true;
+            else if (arg == "off") access_log.enabled = false;
+            else if (arg == "clear") access_log.keys.clear();
+            else { cout << "Usage: record on|off|clear\n"; continue; }
+            cout << "Access recording " << (access_log.enabled ? "on" : "off")
+                 << " (" << access_log.keys.size() << " accesses)\n";
+        }
+        else if (cmd == "mrc") {
+            int maxf = 0, step = 1; ss >> maxf >> step;
+            if (access_log.keys.empty()) { cout << "No recorded accesses. Use 'record on' and run first\n"; continue; }
+            print_mrc(access_log.keys, maxf, step);
+        }
+        else if (cmd == "mrc_approx") {
+            // modo en línea: memoria acotada, sin flujo registrado
+            string first;
+            streampos args = ss.tellg();
+            ss >> first;
+            if (first == "on") {
+                double rate; if (!(ss >> rate) || rate <= 0 || rate > 1) { cout << "mrc_approx on requires a sampling rate in (0,1]\n"; continue; }
+                online_mrc = make_unique<ShardsEngine>(rate);
+                cout << "Online MRC sampling on (rate " << rate << ")\n";
+                continue;
+            }
+            if (first == "off") { online_mrc.reset(); cout << "Online MRC sampling off\n"; continue; }
+            if (first == "show") {
+                if (!online_mrc) { cout << "Online sampling off. Use 'mrc_approx on <rate>' and run first\n"; continue; }
+                int maxf = 0, step = 1; ss >> maxf >> step;
+                print_mrc_online(*online_mrc, maxf, step);
+                continue;
+            }
+            ss.clear();
+            ss.seekg(args);
+            double rate; if (!(ss >> rate) || rate <= 0 || rate > 1) { cout << "mrc_approx requires a sampling rate in (0,1]\n"; continue; }
+            int maxf = 0, step = 1; ss >> maxf >> step;
+            if (access_log.keys.empty()) { cout << "No recorded accesses. Use 'record on' and run first\n"; continue; }
+            print_mrc_approx(access_log.keys, rate, maxf, step);
+        }
+        else if (cmd == "compare_policies") {
+            string arg; ss >> arg;
+            if (arg == "off") { lockstep.mems.clear(); cout << "Policy comparison off\n"; continue; }
+            int nf;
+            try { nf = stoi(arg); } catch (...) { nf = -1; }
+            if (nf <= 0) { cout << "Usage: compare_policies <nframes> [FIFO LRU CLOCK OPT] | off\n"; continue; }
+            vector<ReplPolicy> pols; string name; bool bad = false;
+            while (ss >> name) {
+                ReplPolicy pol;
+                if (!parse_repl_policy(name, pol)) { cout << "Unknown policy " << name << "\n"; bad = true; break; }
+                pols.push_back(pol);
+            }
+            if (bad) continue;
+            if (pols.empty()) pols = {ReplPolicy::FIFO, ReplPolicy::LRU, ReplPolicy::CLOCK, ReplPolicy::OPT};
+            lockstep.start(nf, pols);
+            cout << "Comparing " << pols.size() << " policies with " << nf << " frames on the live access stream\n";
+        }
+        else if (cmd == "memcmp") {
+            if (!lockstep.active()) { cout << "Policy comparison off. Use compare_policies <nframes>\n"; continue; }
+            cout << "Policy comparison at tick " << sched.get_tick() << "\n";
+            lockstep.report();
+        }
+        else if (cmd == "bench_sched") {
+            vector<int> sizes; int n;
+            while (ss >> n) sizes.push_back(n);
+            if (sizes.empty()) sizes = {1000, 4000, 16000};
+            bench_scheduler(sizes);
+        }
+        else if (cmd == "bench_fair") {
+            int n = 16, t = 100000, q = 2;
+            ss >> n >> t >> q;
+            bench_fairness(max(1, n), max(1, t), max(1, q));
+        }
+        else if (cmd == "schedstat") {
+            sched.sched_stats();
+        }
+        else if (cmd == "set_cpus") {
+            int n; if (!(ss >> n) || n < 1) { cout << "set_cpus requires a positive number\n"; continue; }
+            sched.set_cpus(n);
+        }
+        else if (cmd == "cpustat") {
+            sched.cpu_stats();
+        }
+        else if (cmd == "set_balance") {
+            string arg; ss >> arg;
+            if (arg == "NONE") {
+                sched.set_balance(BalanceMode::NONE, 0, 0);
+            } else if (arg == "STEAL") {
+                int threshold = 1, cost = 0; ss >> threshold >> cost;
+                sched.set_balance(BalanceMode::STEAL, threshold, cost);
+            } else if (arg == "PERIODIC") {
+                int period = 50, cost = 0; ss >> period >> cost;
+                sched.set_balance(BalanceMode::PERIODIC, period, cost);
+            } else {
+                cout << "Unknown balance mode. Use NONE, STEAL or PERIODIC\n";
             }
         }
+        else if (cmd == "set_threads") {
+            int t; if (!(ss >> t) || t < 1) { cout << "set_threads requires a positive number\n"; continue; }
+            sched.set_host_threads(t);
+            cout << "Host threads = " << sched.get_host_threads() << " (CPUs = " << sched.num_cpus() << ")\n";
+        }
+        else if (cmd == "bench_parallel") {
+            int ncpus = 8, nprocs = 256, ticks = 20000;
+            ss >> ncpus >> nprocs >> ticks;
+            bench_parallel(max(1, ncpus), max(1, nprocs), max(1, ticks));
+        }
+        else if (cmd == "set_devices") {
+            int n; if (!(ss >> n) || n < 1) { cout << "set_devices requires a positive number\n"; continue; }
+            sched.set_devices(n);
+        }
+        else if (cmd == "set_swap") {
+            int t; if (!(ss >> t) || t < 0) { cout << "set_swap requires a latency >= 0\n"; continue; }
+            sched.set_swap_latency(t);
+        }
+        else if (cmd == "bench_thrash") {
+            int nprocs = 8, pages = 8, burst = 200, latency = 10;
+            ss >> nprocs >> pages >> burst >> latency;
+            nprocs = max(1, nprocs); pages = max(1, pages);
+            int ws = nprocs * pages;
+            vector<int> frames;
+            for (int f = ws / 4; f <= ws + ws / 4; f += max(1, ws / 8)) frames.push_back(max(1, f));
+            bench_thrash(nprocs, pages, max(1, burst), max(0, latency), frames);
+        }
+        else if (cmd == "iostat") {
+            sched.io_stats();
+        }
+        else if (cmd == "bench_io") {
+            int ncpus = 1, nprocs = 20, ndevices = 1;
+            ss >> ncpus >> nprocs >> ndevices;
+            bench_io(max(1, ncpus), max(1, nprocs), max(1, ndevices));
+        }
+        else if (cmd == "balstat") {
+            sched.balance_stats();
+        }
+        else if (cmd == "bench_balance") {
+            int ncpus = 4, nprocs = 64, cost = 2, period = 50;
+            ss >> ncpus >> nprocs >> cost >> period;
+            bench_balance(max(1, ncpus), max(1, nprocs), max(0, cost), max(1, period));
+        }
+        else if (cmd == "bench_mem") {
+            long long n; if (!(ss >> n)) { cout << "bench_mem requires number of accesses\n"; continue; }
+            vector<int> sizes; int nf;
+            bool bad = false;
+            while (ss >> nf) {
+                if (nf < 1) { cout << "Invalid frame count " << nf << ", must be >= 1\n"; bad = true; break; }
+                sizes.push_back(nf);
+            }
+            if (bad) continue;
+            if (sizes.empty()) sizes = {64, 1024, 16384, 65536};
+            bench_memory(n, sizes);
+        }
+        else if (cmd == "tick") {
+            simulate_tick(sched, mem);
+        }
         else if (cmd == "run") {
             int n; if (!(ss >> n)) { cout << "run requires a number\n"; continue; }
-            for (int i = 0; i < n; ++i) {
-                mem.advance_tick();
-                auto ran = sched.tick();
-                if (ran) {
-                    int pid = ran.value();
-                    auto &procs = sched.get_processes_mut();
-                    if (procs.find(pid) != procs.end()) {
-                        PCB &p = procs[pid];
-                        int page = 0;
-                        if (!p.trace.empty()) {
-                            if (p.trace_pos >= (int)p.trace.size()) p.trace_pos = 0;
-                            page = p.trace[p.trace_pos++];
-                            if (page < 0 || page >= p.npages) page = page % p.npages;
-                        } else {
-                            std::uniform_int_distribution<int> dist(0, max(0,p.npages-1));
-                            page = dist(rng);
-                        }
-                        auto res = mem.access_page(pid, page);
-                        if (!res.first) {
-                            p.page_faults++;
-                            cout << "[tick " << sched.get_tick()-1 << "] PAGE_FAULT pid=" << pid << " page=" << page << " loaded in frame=" << res.second << "\n";
-                        } else {
-                            cout << "[tick " << sched.get_tick()-1 << "] HIT pid=" << pid << " page=" << page << "\n";
-                        }
-                    }
-                }
-            }
+            if (event_mode) run_events(sched, mem, n);
+            else for (int i = 0; i < n; ++i) simulate_tick(sched, mem);
+        }
+        else if (cmd == "set_runmode") {
+            string arg; ss >> arg;
+            if (arg == "TICK") event_mode = false;
+            else if (arg == "EVENT") event_mode = true;
+            else { cout << "Usage: set_runmode TICK|EVENT\n"; continue; }
+            sched.set_log_runs(!event_mode);
+            log_hits = !event_mode;
+            cout << "Run mode = " << arg << "\n";
+        }
+        else if (cmd == "seed") {
+            unsigned sd; if (!(ss >> sd)) { cout << "seed requires a number\n"; continue; }
+            rng.seed(sd);
+            sched.seed_lottery(sd);
+            cout << "Random seed = " << sd << "\n";
         }
         else {
             cout << "Comando desconocido. Escribe help.\n";